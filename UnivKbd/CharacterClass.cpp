@@ -0,0 +1,52 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+#include "CharacterClass.h"
+
+// generated by tools/CharacterClassGenerator.cpp
+#include "CharacterClassTable.h"
+
+UnivKbd::CharacterClass UnivKbd::characterClass(QChar character) {
+    char16_t unit = character.unicode();
+    quint8 block = CharacterClassStage1[unit >> 8];
+    quint8 classes = CharacterClassStage2[block][(unit & 0xFF) >> 2];
+    return (CharacterClass)((classes >> ((unit & 3) * 2)) & 3);
+}
+
+UnivKbd::CharacterClass UnivKbd::characterClass(const QString &text) {
+    if (text.isEmpty()) {
+        return CharacterClass::Boundary;
+    }
+
+    // the table only covers the BMP, the few characters outside of it are looked up in the Unicode database
+    if (text.size() >= 2 && text[0].isHighSurrogate() && text[1].isLowSurrogate()) {
+        uint codePoint = QChar::surrogateToUcs4(text[0], text[1]);
+        if (QChar::isLetterOrNumber(codePoint) || QChar::isMark(codePoint)) {
+            return CharacterClass::Word;
+        }
+        return CharacterClass::Boundary;
+    }
+
+    return characterClass(text[0]);
+}
@@ -0,0 +1,59 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+#ifndef UNIVKBD_CHARACTERCLASS_H
+#define UNIVKBD_CHARACTERCLASS_H
+
+#include <QChar>
+#include <QString>
+
+namespace UnivKbd {
+
+    /**
+     * @brief The role of a character when finding the word being typed.
+     */
+    enum class CharacterClass : quint8 {
+        Boundary = 0,  ///< Ends the current word: spaces, punctuation, symbols.
+        Word = 1,      ///< Part of a word: letters, digits and combining marks of any script.
+        Joiner = 2     ///< Part of a word only inside it: apostrophes, hyphens, zero width joiners.
+    };
+
+    /**
+     * @brief Returns the class of a character of the Basic Multilingual Plane.
+     *
+     * The class is read from a two-stage table generated at build time, so this is a single lookup.
+     * Surrogates are boundaries, see characterClass(const QString &) for characters outside of the BMP.
+     */
+    CharacterClass characterClass(QChar character);
+
+    /**
+     * @brief Returns the class of the first character of a string, which may be outside of the BMP.
+     *
+     * @return The class, or CharacterClass::Boundary if the string is empty.
+     */
+    CharacterClass characterClass(const QString &text);
+
+}
+
+#endif // UNIVKBD_CHARACTERCLASS_H
@@ -0,0 +1,84 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "CharacterRemap.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+
+#include <algorithm>
+
+UnivKbd::CharacterRemap::CharacterRemap(const QString &from, const QString &to) : mBlocks(256, 0) {
+    int size = std::min(from.size(), to.size());
+    for (int i = 0; i < size; i++) {
+        set(from.at(i), to.at(i));
+        set(from.at(i).toUpper(), to.at(i).toUpper());
+    }
+}
+
+std::shared_ptr<const UnivKbd::CharacterRemap> UnivKbd::CharacterRemap::forLayouts(const QString &from, const QString &to) {
+    static QMutex mutex;
+    static QHash<QPair<QString, QString>, std::shared_ptr<const CharacterRemap>> remaps;
+
+    QMutexLocker locker(&mutex);
+    std::shared_ptr<const CharacterRemap> &remap = remaps[qMakePair(from, to)];
+    if (remap == nullptr) {
+        remap = std::make_shared<const CharacterRemap>(from, to);
+    }
+    return remap;
+}
+
+QString UnivKbd::CharacterRemap::map(const QString &text) const {
+    const QChar *source = text.constData();
+    int size = text.size();
+
+    // most labels, like digits and punctuation, are not remapped and keep sharing their data
+    int first = 0;
+    while (first < size && map(source[first]) == source[first]) {
+        first++;
+    }
+    if (first == size) {
+        return text;
+    }
+
+    QString result(size, Qt::Uninitialized);
+    QChar *destination = result.data();
+    std::copy(source, source + first, destination);
+    for (int i = first; i < size; i++) {
+        destination[i] = map(source[i]);
+    }
+    return result;
+}
+
+void UnivKbd::CharacterRemap::set(QChar from, QChar to) {
+    char16_t unit = from.unicode();
+    quint16 &block = mStage1[unit >> 8];
+    if (block == 0) {
+        // a block is allocated with the first remapped character falling in it, the others keep a zero delta
+        block = quint16(mBlocks.size() / 256);
+        mBlocks.resize(mBlocks.size() + 256, 0);
+    }
+    mBlocks[(size_t(block) << 8) | (unit & 0xFF)] = quint16(to.unicode() - unit);
+}
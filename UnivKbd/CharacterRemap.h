@@ -0,0 +1,100 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#ifndef UNIVKBD_CHARACTERREMAP_H
+#define UNIVKBD_CHARACTERREMAP_H
+
+#include <QChar>
+#include <QString>
+
+#include <memory>
+#include <vector>
+
+namespace UnivKbd {
+
+    /**
+     * @class CharacterRemap
+     *
+     * @brief Maps every character of the Basic Multilingual Plane to another one, to convert a keyboard from a layout
+     * to another.
+     *
+     * The map is a two-stage table of deltas: the high byte of a character selects a block of 256 deltas, and the low
+     * byte the delta to add to the character. Blocks without any remapped character share the first block, made of
+     * zeros, so a remap of a few letters only takes a couple of blocks, and remapping a character is two lookups.
+     */
+    class CharacterRemap {
+    public:
+        /**
+         * @brief Constructs a remap converting the characters of a layout to another.
+         *
+         * Each character of from is mapped to the character at the same position in to, and so are their upper case
+         * versions. The other characters are left unchanged.
+         *
+         * @param from The characters of the source layout, like "qwertyuiopasdfghjklzxcvbnm".
+         * @param to The characters of the destination layout, at least as long as from.
+         */
+        CharacterRemap(const QString &from, const QString &to);
+
+        /**
+         * @brief Returns the remap between two layouts, built the first time it is requested and shared afterwards.
+         *
+         * This method is thread-safe.
+         *
+         * @see CharacterRemap(const QString &, const QString &)
+         */
+        static std::shared_ptr<const CharacterRemap> forLayouts(const QString &from, const QString &to);
+
+        /**
+         * @brief Returns true if the remap leaves every character unchanged.
+         */
+        inline bool isIdentity() const {
+            return mBlocks.size() == 256;
+        }
+
+        /**
+         * @brief Returns the character a character is mapped to.
+         */
+        inline QChar map(QChar character) const {
+            char16_t unit = character.unicode();
+            return QChar(char16_t(unit + mBlocks[(size_t(mStage1[unit >> 8]) << 8) | (unit & 0xFF)]));
+        }
+
+        /**
+         * @brief Maps every character of a string.
+         *
+         * @param text The string to convert.
+         * @return The converted string. It shares the data of text when no character of it is remapped.
+         */
+        QString map(const QString &text) const;
+
+    private:
+        void set(QChar from, QChar to);
+
+    private:
+        quint16 mStage1[256] = {};
+        std::vector<quint16> mBlocks;  // the deltas, the first block is all zeros
+    };
+
+}
+
+#endif // UNIVKBD_CHARACTERREMAP_H
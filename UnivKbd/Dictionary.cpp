@@ -0,0 +1,639 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "Dictionary.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <queue>
+
+static_assert(sizeof(UnivKbd::DictionaryHeader) == 16, "DictionaryHeader must match the binary format");
+static_assert(sizeof(UnivKbd::DictionaryNode) == 20, "DictionaryNode must match the binary format");
+
+namespace {
+
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    // converts a node between the host and the file byte order, in both directions
+    UnivKbd::DictionaryNode toLittleEndian(UnivKbd::DictionaryNode node) {
+        node.character = qToLittleEndian(node.character);
+        node.isWord = qToLittleEndian(node.isWord);
+        node.firstChild = qToLittleEndian(node.firstChild);
+        node.childCount = qToLittleEndian(node.childCount);
+        node.frequency = qToLittleEndian(node.frequency);
+        node.maxFrequency = qToLittleEndian(node.maxFrequency);
+        return node;
+    }
+#endif
+
+    // checks once that the children of every node are in the node array and stored after it, as the builder does, so
+    // that the queries can follow them without any bounds check or cycle
+    bool validNodes(const UnivKbd::DictionaryNode *nodes, quint32 nodeCount, quint32 wordCount) {
+        if (nodeCount == 0) {
+            return wordCount == 0;
+        }
+        for (quint32 i = 0; i < nodeCount; i++) {
+            const UnivKbd::DictionaryNode &node = nodes[i];
+            if (node.childCount != 0 && (node.firstChild <= i || (quint64)node.firstChild + node.childCount > nodeCount)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::pair<QString, quint32>> rankByPosition(const QStringList &words) {
+        // the first word is the most frequent one
+        std::vector<std::pair<QString, quint32>> rankedWords;
+        rankedWords.reserve(words.size());
+        for (int i = 0; i < words.size(); i++) {
+            rankedWords.emplace_back(words[i], (quint32)(words.size() - i));
+        }
+        return rankedWords;
+    }
+
+}
+
+UnivKbd::Dictionary::Dictionary(const QStringList &words) : Dictionary(rankByPosition(words)) {
+
+}
+
+UnivKbd::Dictionary::Dictionary(std::vector<std::pair<QString, quint32>> words) {
+
+    for (auto &word : words) {
+        word.first = word.first.trimmed();
+        word.second = std::max<quint32>(word.second, 1);
+    }
+    words.erase(std::remove_if(words.begin(), words.end(), [](const std::pair<QString, quint32> &word) {
+        return word.first.isEmpty();
+    }), words.end());
+
+    // sort by word, the most frequent duplicate first, and keep only that one
+    std::sort(words.begin(), words.end(), [](const std::pair<QString, quint32> &a, const std::pair<QString, quint32> &b) {
+        if (a.first != b.first) {
+            return a.first < b.first;
+        }
+        return a.second > b.second;
+    });
+    words.erase(std::unique(words.begin(), words.end(), [](const std::pair<QString, quint32> &a, const std::pair<QString, quint32> &b) {
+        return a.first == b.first;
+    }), words.end());
+
+    mWordCount = (int)words.size();
+    if (words.empty()) {
+        return;
+    }
+
+    // Build the tree breadth first, so that the children of every node are contiguous in the node array.
+    // Each range of sorted words [begin, end) shares the prefix of length depth leading to node.
+    struct Range {
+        int begin;
+        int end;
+        int depth;
+        quint32 node;
+    };
+
+    auto storage = std::make_shared<std::vector<DictionaryNode>>();
+    std::vector<DictionaryNode> &nodes = *storage;
+
+    std::queue<Range> ranges;
+    nodes.push_back({0, 0, 0, 0, 0, 0});
+    ranges.push({0, (int)words.size(), 0, 0});
+
+    while (!ranges.empty()) {
+        Range range = ranges.front();
+        ranges.pop();
+
+        int begin = range.begin;
+
+        // words are sorted, so the word equal to the prefix is always the first of the range
+        if (words[begin].first.size() == range.depth) {
+            nodes[range.node].isWord = 1;
+            nodes[range.node].frequency = words[begin].second;
+            begin++;
+        }
+
+        nodes[range.node].firstChild = (quint32)nodes.size();
+
+        while (begin < range.end) {
+            quint16 character = words[begin].first.at(range.depth).unicode();
+            int end = begin + 1;
+            while (end < range.end && words[end].first.at(range.depth).unicode() == character) {
+                end++;
+            }
+
+            ranges.push({begin, end, range.depth + 1, (quint32)nodes.size()});
+            nodes.push_back({character, 0, 0, 0, 0, 0});
+            nodes[range.node].childCount++;
+
+            begin = end;
+        }
+    }
+
+    // children are always stored after their parent, so a reverse pass sees every subtree before its root
+    for (std::size_t i = nodes.size(); i-- > 0;) {
+        DictionaryNode &node = nodes[i];
+        node.maxFrequency = node.frequency;
+        for (quint32 child = node.firstChild; child < node.firstChild + node.childCount; child++) {
+            node.maxFrequency = std::max(node.maxFrequency, nodes[child].maxFrequency);
+        }
+    }
+
+    mNodes = nodes.data();
+    mNodeCount = (quint32)nodes.size();
+    mStorage = storage;
+
+}
+
+UnivKbd::Dictionary UnivKbd::Dictionary::fromTextFile(const QString &path, bool *ok) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (ok != nullptr) {
+            *ok = false;
+        }
+        return Dictionary();
+    }
+    if (ok != nullptr) {
+        *ok = true;
+    }
+
+    std::vector<std::pair<QString, quint32>> words;
+    std::vector<std::size_t> unrankedWords;
+
+    QTextStream in(&file);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    in.setCodec("UTF-8");
+#endif
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        int separator = std::max(line.lastIndexOf(QLatin1Char('\t')), line.lastIndexOf(QLatin1Char(' ')));
+        bool hasFrequency = false;
+        qulonglong frequency = 0;
+        if (separator > 0) {
+            frequency = line.mid(separator + 1).toULongLong(&hasFrequency);
+        }
+
+        if (hasFrequency) {
+            words.emplace_back(line.left(separator), (quint32)std::min<qulonglong>(frequency, std::numeric_limits<quint32>::max()));
+        } else {
+            unrankedWords.push_back(words.size());
+            words.emplace_back(line, 0);
+        }
+    }
+
+    // words without a frequency are ranked by their position in the file
+    for (std::size_t i = 0; i < unrankedWords.size(); i++) {
+        words[unrankedWords[i]].second = (quint32)(unrankedWords.size() - i);
+    }
+
+    return Dictionary(std::move(words));
+}
+
+UnivKbd::Dictionary UnivKbd::Dictionary::fromBinaryFile(const QString &path, bool *ok) {
+    if (ok != nullptr) {
+        *ok = false;
+    }
+
+    auto file = std::make_shared<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        return Dictionary();
+    }
+
+    DictionaryHeader header;
+    if (file->read((char*)&header, sizeof(header)) != (qint64)sizeof(header)) {
+        return Dictionary();
+    }
+    if (std::memcmp(header.magic, "UKDC", 4) != 0 || qFromLittleEndian(header.version) != 1) {
+        qDebug() << "Not a valid dictionary file" << path;
+        return Dictionary();
+    }
+
+    quint32 nodeCount = qFromLittleEndian(header.nodeCount);
+    qint64 nodesSize = (qint64)nodeCount * (qint64)sizeof(DictionaryNode);
+    if (file->size() < (qint64)sizeof(header) + nodesSize) {
+        qDebug() << "Truncated dictionary file" << path;
+        return Dictionary();
+    }
+
+    quint32 wordCount = qFromLittleEndian(header.wordCount);
+    if (wordCount > (quint32)std::numeric_limits<int>::max()) {
+        qDebug() << "Not a valid dictionary file" << path;
+        return Dictionary();
+    }
+
+    Dictionary dictionary;
+    dictionary.mNodeCount = nodeCount;
+    dictionary.mWordCount = (int)wordCount;
+
+    const uchar *data = file->map(0, (qint64)sizeof(header) + nodesSize);
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    if (data != nullptr && (quintptr)(data + sizeof(header)) % alignof(DictionaryNode) == 0) {
+        const DictionaryNode *nodes = reinterpret_cast<const DictionaryNode*>(data + sizeof(header));
+        if (!validNodes(nodes, nodeCount, wordCount)) {
+            qDebug() << "Corrupted dictionary file" << path;
+            return Dictionary();
+        }
+
+        // the mapping lives as long as the file is open, so the dictionary keeps the file
+        dictionary.mNodes = nodes;
+        dictionary.mStorage = file;
+        if (ok != nullptr) {
+            *ok = true;
+        }
+        return dictionary;
+    }
+#endif
+
+    // compressed resources cannot be mapped, and misaligned or big-endian data cannot be used in place
+    auto nodes = std::make_shared<std::vector<DictionaryNode>>(nodeCount);
+    if (data != nullptr) {
+        std::memcpy(nodes->data(), data + sizeof(header), nodesSize);
+    } else if (file->read((char*)nodes->data(), nodesSize) != nodesSize) {
+        return Dictionary();
+    }
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    for (auto &node : *nodes) {
+        node = toLittleEndian(node);
+    }
+#endif
+    if (!validNodes(nodes->data(), nodeCount, wordCount)) {
+        qDebug() << "Corrupted dictionary file" << path;
+        return Dictionary();
+    }
+
+    dictionary.mNodes = nodes->data();
+    dictionary.mStorage = nodes;
+    if (ok != nullptr) {
+        *ok = true;
+    }
+    return dictionary;
+}
+
+UnivKbd::Dictionary UnivKbd::Dictionary::fromFile(const QString &path, bool *ok) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (ok != nullptr) {
+            *ok = false;
+        }
+        return Dictionary();
+    }
+
+    if (file.peek(4) == "UKDC") {
+        return fromBinaryFile(path, ok);
+    }
+    return fromTextFile(path, ok);
+}
+
+bool UnivKbd::Dictionary::saveBinaryFile(const QString &path) const {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    DictionaryHeader header;
+    std::memcpy(header.magic, "UKDC", 4);
+    header.version = qToLittleEndian<quint32>(1);
+    header.nodeCount = qToLittleEndian(mNodeCount);
+    header.wordCount = qToLittleEndian((quint32)mWordCount);
+    if (file.write((const char*)&header, sizeof(header)) != (qint64)sizeof(header)) {
+        return false;
+    }
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    qint64 nodesSize = (qint64)mNodeCount * (qint64)sizeof(DictionaryNode);
+    return file.write((const char*)mNodes, nodesSize) == nodesSize;
+#else
+    for (quint32 i = 0; i < mNodeCount; i++) {
+        DictionaryNode node = toLittleEndian(mNodes[i]);
+        if (file.write((const char*)&node, sizeof(node)) != (qint64)sizeof(node)) {
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+bool UnivKbd::Dictionary::contains(const QString &word) const {
+    qint64 node = findNode(word);
+    return node >= 0 && mNodes[node].isWord != 0;
+}
+
+quint32 UnivKbd::Dictionary::frequency(const QString &word) const {
+    qint64 node = findNode(word);
+    return node >= 0 ? mNodes[node].frequency : 0;
+}
+
+QStringList UnivKbd::Dictionary::complete(const QString &prefix, int maxResults) const {
+    if (maxResults <= 0) {
+        return QStringList();
+    }
+
+    qint64 node = findNode(prefix);
+    if (node < 0) {
+        return QStringList();
+    }
+
+    return completeFromNode((quint32)node, prefix, maxResults);
+}
+
+struct UnivKbd::Dictionary::FuzzySearch {
+    struct Match {
+        quint32 node;
+        QString path;
+        int distance;
+        quint32 maxFrequency;
+    };
+
+    const QString &prefix;
+    int maxDistance;
+    qint64 budget;
+    QElapsedTimer timer;
+    int visitedNodes;
+    bool expired;
+
+    // rows[depth * width + j] is the edit distance between the first depth characters of path and of prefix
+    int width;
+    std::vector<int> rows;
+    QString path;
+
+    std::vector<Match> matches;
+};
+
+QStringList UnivKbd::Dictionary::completeFuzzy(const QString &prefix, int maxResults, int maxDistance, qint64 budget) const {
+    if (mNodeCount == 0 || maxResults <= 0 || prefix.isEmpty()) {
+        return QStringList();
+    }
+
+    FuzzySearch search{prefix, maxDistance, budget, QElapsedTimer(), 0, false, (int)prefix.size() + 1, {}, QString(), {}};
+    search.timer.start();
+
+    // a path longer than the prefix plus maxDistance cannot be close enough, so this is the deepest row needed
+    search.rows.resize((prefix.size() + maxDistance + 2) * search.width);
+    for (int j = 0; j < search.width; j++) {
+        search.rows[j] = j;
+    }
+
+    searchFuzzy(search, 0, 0);
+
+    // a subtree matched by deleting the end of the prefix may hold nothing but the words starting with the exact
+    // prefix, so all the matches are ordered, and expanded until enough words are found
+    std::sort(search.matches.begin(), search.matches.end(), [](const FuzzySearch::Match &a, const FuzzySearch::Match &b) {
+        if (a.distance != b.distance) {
+            return a.distance < b.distance;
+        }
+        return a.maxFrequency > b.maxFrequency;
+    });
+
+    // The matched subtrees are disjoint, so no word is returned twice. The subtree of the exact prefix is left out
+    // while expanding, instead of filtering its words afterwards, so that they do not use up maxResults.
+    qint64 exactNode = findNode(prefix);
+    QStringList results;
+    for (const auto &match : search.matches) {
+        if (results.size() >= maxResults) {
+            break;
+        }
+        results << completeFromNode(match.node, match.path, maxResults - results.size(), exactNode);
+    }
+    return results;
+}
+
+void UnivKbd::Dictionary::searchFuzzy(FuzzySearch &search, quint32 node, int depth) const {
+    const QString &prefix = search.prefix;
+    const int width = search.width;
+    const int *previousRow = &search.rows[depth * width];
+    int *row = &search.rows[(depth + 1) * width];
+
+    const DictionaryNode &current = mNodes[node];
+    for (quint32 child = current.firstChild; child < current.firstChild + current.childCount; child++) {
+        // reading the clock is not free, so the budget is only checked every few nodes
+        if (search.expired || (++search.visitedNodes % 64 == 0 && search.timer.nsecsElapsed() > search.budget)) {
+            search.expired = true;
+            return;
+        }
+
+        QChar character(mNodes[child].character);
+
+        row[0] = depth + 1;
+        int bestDistance = row[0];
+        for (int j = 1; j < width; j++) {
+            int substitution = previousRow[j - 1] + (prefix.at(j - 1) == character ? 0 : 1);
+            row[j] = std::min({previousRow[j] + 1, row[j - 1] + 1, substitution});
+            if (depth >= 1 && j >= 2 && prefix.at(j - 2) == character && prefix.at(j - 1) == search.path.at(depth - 1)) {
+                row[j] = std::min(row[j], search.rows[(depth - 1) * width + j - 2] + 1);
+            }
+            bestDistance = std::min(bestDistance, row[j]);
+        }
+
+        // no word below this node can be close enough to the prefix
+        if (bestDistance > search.maxDistance) {
+            continue;
+        }
+
+        int distance = row[width - 1];
+
+        // the subtree of the exact prefix is already covered by complete()
+        if (distance == 0) {
+            continue;
+        }
+
+        search.path.append(character);
+        if (distance <= search.maxDistance) {
+            search.matches.push_back({child, search.path, distance, mNodes[child].maxFrequency});
+        } else if ((std::size_t)(depth + 2) * width < search.rows.size()) {
+            searchFuzzy(search, child, depth + 1);
+        }
+        search.path.chop(1);
+    }
+}
+
+qint64 UnivKbd::Dictionary::findChild(quint32 node, QChar character) const {
+    const DictionaryNode &parent = mNodes[node];
+    const DictionaryNode *begin = mNodes + parent.firstChild;
+    const DictionaryNode *end = begin + parent.childCount;
+    const DictionaryNode *child = std::lower_bound(begin, end, (quint16)character.unicode(), [](const DictionaryNode &candidate, quint16 value) {
+        return candidate.character < value;
+    });
+    if (child == end || child->character != character.unicode()) {
+        return -1;
+    }
+    return child - mNodes;
+}
+
+qint64 UnivKbd::Dictionary::findNode(const QString &prefix) const {
+    if (mNodeCount == 0) {
+        return -1;
+    }
+
+    qint64 node = 0;
+    for (const QChar &character : prefix) {
+        node = findChild((quint32)node, character);
+        if (node < 0) {
+            return -1;
+        }
+    }
+
+    return node;
+}
+
+QStringList UnivKbd::Dictionary::completeFromNode(quint32 node, const QString &prefix, int maxResults, qint64 excludedNode) const {
+
+    // Best-first search. A candidate is either a whole subtree, ranked by the best frequency it contains, or a
+    // single word, ranked by its own frequency. A subtree is only expanded once it is the best candidate left,
+    // so for a short prefix only the branches leading to the best words are read.
+    struct Path {
+        quint32 node;
+        qint32 parent;
+    };
+
+    struct Candidate {
+        quint32 priority;
+        bool isWord;
+        qint32 path;
+    };
+
+    auto isWorse = [](const Candidate &a, const Candidate &b) {
+        if (a.priority != b.priority) {
+            return a.priority < b.priority;
+        }
+        // on equal frequencies, words come before subtrees and shorter paths before longer ones
+        if (a.isWord != b.isWord) {
+            return !a.isWord;
+        }
+        return a.path > b.path;
+    };
+
+    std::vector<Path> paths;
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(isWorse)> candidates(isWorse);
+
+    paths.push_back({node, -1});
+    candidates.push({mNodes[node].maxFrequency, false, 0});
+
+    QStringList results;
+    while (!candidates.empty() && results.size() < maxResults) {
+        Candidate candidate = candidates.top();
+        candidates.pop();
+
+        if (candidate.isWord) {
+            int length = 0;
+            for (qint32 path = candidate.path; paths[path].parent >= 0; path = paths[path].parent) {
+                length++;
+            }
+
+            QString word = prefix;
+            word.resize(prefix.size() + length);
+            int position = word.size();
+            for (qint32 path = candidate.path; paths[path].parent >= 0; path = paths[path].parent) {
+                word[--position] = QChar(mNodes[paths[path].node].character);
+            }
+
+            results << word;
+            continue;
+        }
+
+        const DictionaryNode &current = mNodes[paths[candidate.path].node];
+        if (current.isWord) {
+            candidates.push({current.frequency, true, candidate.path});
+        }
+        for (quint32 child = current.firstChild; child < current.firstChild + current.childCount; child++) {
+            if ((qint64)child == excludedNode) {
+                continue;
+            }
+            paths.push_back({child, candidate.path});
+            candidates.push({mNodes[child].maxFrequency, false, (qint32)paths.size() - 1});
+        }
+    }
+
+    return results;
+}
+
+UnivKbd::DictionaryCursor::DictionaryCursor(const Dictionary *dictionary) : mDictionary(dictionary) {
+    reset();
+}
+
+void UnivKbd::DictionaryCursor::reset() {
+    mPrefix.clear();
+    mLevels.clear();
+
+    bool hasRoot = mDictionary != nullptr && mDictionary->mNodeCount > 0;
+    mLevels.push_back({hasRoot ? 0 : -1, 0, QStringList()});
+}
+
+void UnivKbd::DictionaryCursor::reset(const QString &prefix) {
+    reset();
+    for (const QChar &character : prefix) {
+        append(character);
+    }
+}
+
+void UnivKbd::DictionaryCursor::append(QChar character) {
+    qint64 node = mLevels.back().node;
+    if (node >= 0) {
+        node = mDictionary->findChild((quint32)node, character);
+    }
+
+    mPrefix.append(character);
+    mLevels.push_back({node, 0, QStringList()});
+}
+
+void UnivKbd::DictionaryCursor::backspace() {
+    if (mLevels.size() <= 1) {
+        return;
+    }
+
+    mLevels.pop_back();
+    mPrefix.chop(1);
+}
+
+QStringList UnivKbd::DictionaryCursor::suggestions(int maxResults) {
+    Level &level = mLevels.back();
+    if (mDictionary == nullptr || maxResults <= 0) {
+        return QStringList();
+    }
+
+    if (level.cachedMaxResults != maxResults) {
+        QStringList results;
+        if (level.node >= 0) {
+            results = mDictionary->completeFromNode((quint32)level.node, mPrefix, maxResults);
+        }
+
+        // any single character is one edit away from every word, so typos are only corrected from two characters
+        if (results.size() < maxResults && mFuzzyBudget > 0 && mPrefix.size() >= 2) {
+            int maxDistance = mPrefix.size() < 5 ? 1 : 2;
+            results << mDictionary->completeFuzzy(mPrefix, maxResults - results.size(), maxDistance, mFuzzyBudget);
+        }
+
+        level.cachedResults = results;
+        level.cachedMaxResults = maxResults;
+    }
+    return level.cachedResults;
+}
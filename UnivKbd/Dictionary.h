@@ -0,0 +1,323 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#ifndef UNIVKBD_DICTIONARY_H
+#define UNIVKBD_DICTIONARY_H
+
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace UnivKbd {
+
+    /**
+     * @brief A node of the dictionary prefix tree.
+     *
+     * Nodes are stored in a single flat array. The children of a node are contiguous and sorted by character,
+     * so that a child can be found with a binary search.
+     */
+    struct DictionaryNode {
+        quint16 character;     ///< The UTF-16 code unit leading to this node.
+        quint16 isWord;        ///< Non-zero when the path from the root to this node is a word.
+        quint32 firstChild;    ///< Index of the first child in the node array.
+        quint32 childCount;    ///< Number of children.
+        quint32 frequency;     ///< Frequency of the word ending at this node, 0 if it is not a word.
+        quint32 maxFrequency;  ///< Highest frequency of the words in the subtree of this node.
+    };
+
+    /**
+     * @brief The header of a binary dictionary file.
+     *
+     * A binary dictionary file is made of this header, followed by the nodes of the dictionary, in little-endian
+     * byte order. It can be used in place, without any parsing.
+     *
+     * @see Dictionary::saveBinaryFile
+     */
+    struct DictionaryHeader {
+        char magic[4];       ///< Always "UKDC".
+        quint32 version;     ///< The version of the format, currently 1.
+        quint32 nodeCount;   ///< The number of nodes following the header.
+        quint32 wordCount;   ///< The number of words in the dictionary.
+    };
+
+    /**
+     * @class Dictionary
+     *
+     * @brief A prefix index over a list of words, used to compute the suggestions.
+     *
+     * Every word has a frequency, and the completions of a prefix are returned from the most to the least frequent.
+     * Each node stores the highest frequency of its subtree, so that finding the k best completions only visits
+     * the branches that can contain them, whatever the size of the dictionary.
+     *
+     * A dictionary is immutable, and copying it shares its nodes. Dictionaries loaded from a binary file are mapped
+     * in memory and queried in place.
+     */
+    class Dictionary {
+    public:
+        /**
+         * @brief Constructs an empty dictionary.
+         */
+        Dictionary() = default;
+
+        /**
+         * @brief Constructs a dictionary from a list of words sorted from the most to the least frequent.
+         *
+         * @param words The words of the dictionary. Duplicates and empty words are ignored.
+         */
+        explicit Dictionary(const QStringList &words);
+
+        /**
+         * @brief Constructs a dictionary from a list of words and their frequencies.
+         *
+         * @param words The words of the dictionary with their frequencies. Empty words are ignored, and only the
+         * highest frequency of a duplicated word is kept.
+         */
+        explicit Dictionary(std::vector<std::pair<QString, quint32>> words);
+
+        /**
+         * @brief Loads a dictionary from a text file.
+         *
+         * The file contains one word per line, optionally followed by a tab or a space and its frequency:
+         * ```
+         * the	23135851
+         * of	13151942
+         * and
+         * ```
+         * Words without a frequency are ranked by their position in the file, the first line being the most frequent.
+         *
+         * @param path The path of the file.
+         * @param ok If not null, set to false when the file could not be opened.
+         * @return The loaded dictionary.
+         */
+        static Dictionary fromTextFile(const QString &path, bool *ok = nullptr);
+
+        /**
+         * @brief Loads a dictionary from a binary file.
+         *
+         * The file is mapped in memory and used in place, so loading does not depend on the size of the dictionary,
+         * and the memory pages are shared between processes. Files that cannot be mapped, like compressed
+         * resources, are read in memory instead.
+         *
+         * @param path The path of the file.
+         * @param ok If not null, set to false when the file could not be opened or is not a valid dictionary.
+         * @return The loaded dictionary.
+         * @see saveBinaryFile
+         */
+        static Dictionary fromBinaryFile(const QString &path, bool *ok = nullptr);
+
+        /**
+         * @brief Loads a dictionary from a binary or a text file, depending on its content.
+         *
+         * @param path The path of the file.
+         * @param ok If not null, set to false when the file could not be loaded.
+         * @return The loaded dictionary.
+         */
+        static Dictionary fromFile(const QString &path, bool *ok = nullptr);
+
+        /**
+         * @brief Saves the dictionary to a binary file.
+         *
+         * @param path The path of the file.
+         * @return True on success.
+         * @see fromBinaryFile
+         */
+        bool saveBinaryFile(const QString &path) const;
+
+        /**
+         * @brief Returns true if the dictionary does not contain any word.
+         */
+        inline bool isEmpty() const {
+            return mWordCount == 0;
+        }
+
+        /**
+         * @brief Returns the number of words in the dictionary.
+         */
+        inline int size() const {
+            return mWordCount;
+        }
+
+        /**
+         * @brief Returns the size of the nodes of the dictionary, in bytes.
+         */
+        inline qint64 memoryUsage() const {
+            return qint64(mNodeCount) * qint64(sizeof(DictionaryNode));
+        }
+
+        /**
+         * @brief Returns true if the given word is in the dictionary.
+         */
+        bool contains(const QString &word) const;
+
+        /**
+         * @brief Returns the frequency of the given word, or 0 if it is not in the dictionary.
+         */
+        quint32 frequency(const QString &word) const;
+
+        /**
+         * @brief Returns the most frequent words starting with the given prefix.
+         *
+         * @param prefix The prefix to complete.
+         * @param maxResults The maximum number of words to return.
+         * @return At most maxResults words starting with prefix, from the most to the least frequent.
+         */
+        QStringList complete(const QString &prefix, int maxResults) const;
+
+        /**
+         * @brief Returns the most frequent words starting with a prefix close to the given one.
+         *
+         * The words are looked up with a Levenshtein automaton walking the prefix tree: a branch is abandoned as soon
+         * as it cannot match the prefix within maxDistance insertions, deletions, substitutions or transpositions.
+         * Words starting with the exact prefix are left out, since complete() already returns them.
+         *
+         * @param prefix The prefix to complete, possibly with typos.
+         * @param maxResults The maximum number of words to return.
+         * @param maxDistance The maximum edit distance between prefix and the beginning of the words.
+         * @param budget The maximum time to spend searching, in nanoseconds. The best words found so far are returned
+         * when it expires.
+         * @return At most maxResults words, the closest first, then from the most to the least frequent.
+         */
+        QStringList completeFuzzy(const QString &prefix, int maxResults, int maxDistance, qint64 budget) const;
+
+    private:
+        friend class DictionaryCursor;
+
+        struct FuzzySearch;
+
+        void searchFuzzy(FuzzySearch &search, quint32 node, int depth) const;
+
+        qint64 findChild(quint32 node, QChar character) const;
+
+        qint64 findNode(const QString &prefix) const;
+
+        QStringList completeFromNode(quint32 node, const QString &prefix, int maxResults, qint64 excludedNode = -1) const;
+
+    private:
+        std::shared_ptr<const void> mStorage;
+        const DictionaryNode *mNodes = nullptr;
+        quint32 mNodeCount = 0;
+        int mWordCount = 0;
+    };
+
+    /**
+     * @class DictionaryCursor
+     *
+     * @brief Follows a word being typed in a dictionary.
+     *
+     * The cursor keeps the node reached by every prefix of the word, so appending or removing a character does not
+     * search the dictionary from its root again. The suggestions computed for each prefix are cached, and are
+     * returned immediately when backspacing to that prefix.
+     *
+     * When few words start with the current word, the suggestions are completed with words starting with a close
+     * prefix, to correct typos.
+     *
+     * The dictionary must outlive the cursor.
+     */
+    class DictionaryCursor {
+    public:
+        /**
+         * @brief The default time budget to look for typo corrections on each keystroke, in nanoseconds.
+         */
+        static constexpr qint64 DefaultFuzzyBudget = 2000000;
+
+        /**
+         * @brief Constructs a cursor over no dictionary, which never suggests anything.
+         */
+        DictionaryCursor() : DictionaryCursor(nullptr) {
+
+        }
+
+        /**
+         * @brief Constructs a cursor at the root of the given dictionary.
+         *
+         * @param dictionary The dictionary to follow, or nullptr.
+         */
+        explicit DictionaryCursor(const Dictionary *dictionary);
+
+        /**
+         * @brief Returns the word followed by the cursor.
+         */
+        inline const QString &prefix() const {
+            return mPrefix;
+        }
+
+        /**
+         * @brief Moves the cursor back to an empty word.
+         */
+        void reset();
+
+        /**
+         * @brief Moves the cursor to the given word.
+         */
+        void reset(const QString &prefix);
+
+        /**
+         * @brief Appends a character to the word.
+         */
+        void append(QChar character);
+
+        /**
+         * @brief Removes the last character of the word, if any.
+         */
+        void backspace();
+
+        /**
+         * @brief Sets the time budget to look for typo corrections on each keystroke.
+         *
+         * @param budget The budget in nanoseconds, or 0 to only suggest words starting with the current word.
+         */
+        inline void setFuzzyBudget(qint64 budget) {
+            mFuzzyBudget = budget;
+            for (auto &level : mLevels) {
+                level.cachedMaxResults = 0;
+            }
+        }
+
+        /**
+         * @brief Returns the suggestions for the current word.
+         *
+         * @param maxResults The maximum number of words to return.
+         * @return The words of Dictionary::complete() followed, if there is room left, by the words of
+         * Dictionary::completeFuzzy(). The result is cached for the current word.
+         */
+        QStringList suggestions(int maxResults);
+
+    private:
+        struct Level {
+            qint64 node;
+            int cachedMaxResults;
+            QStringList cachedResults;
+        };
+
+        const Dictionary *mDictionary;
+        qint64 mFuzzyBudget = DefaultFuzzyBudget;
+        QString mPrefix;
+        std::vector<Level> mLevels;
+    };
+
+}
+
+#endif // UNIVKBD_DICTIONARY_H
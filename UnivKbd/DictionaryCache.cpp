@@ -0,0 +1,149 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+#include "DictionaryCache.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+UnivKbd::DictionaryCache &UnivKbd::DictionaryCache::instance() {
+    static DictionaryCache cache;
+    return cache;
+}
+
+UnivKbd::DictionaryCache::DictionaryCache() {
+    setMaxMemory(DefaultMaxMemory);
+}
+
+QHash<QString, QString> UnivKbd::DictionaryCache::loadLanguages(const QString &path) {
+    QHash<QString, QString> languages;
+
+    QFile file(path);
+    file.open(QIODevice::ReadOnly);
+    if (!file.isOpen()) {
+        qDebug() << "Could not open languages file";
+        return languages;
+    }
+    /* File format :
+    Swiss French : French
+    United Kingdom : English
+     */
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine());
+        QStringList parts = line.split(":");
+        if (parts.size() != 2) {
+            continue;
+        }
+        languages[parts[0].trimmed()] = parts[1].trimmed();
+    }
+    return languages;
+}
+
+QString UnivKbd::DictionaryCache::languageForKeyboard(const QString &keyboard) {
+    // parsed once, the initialization of a local static is thread-safe
+    static const QHash<QString, QString> languages = loadLanguages(":/languages.txt");
+
+    auto it = languages.find(keyboard);
+    if (it != languages.end()) {
+        return it.value();
+    }
+
+    // strip the variant of the layout: "Russian - Mnemonic", "Russian (Typewriter)"
+    QString name = keyboard;
+    int dash = name.indexOf(" - ");
+    if (dash >= 0) {
+        name.truncate(dash);
+    }
+    int open;
+    while ((open = name.indexOf('(')) >= 0) {
+        int close = name.indexOf(')', open);
+        name.remove(open, close < 0 ? name.size() - open : close - open + 1);
+    }
+    name = name.simplified();
+
+    return languages.value(name, name);
+}
+
+std::shared_ptr<const UnivKbd::Dictionary> UnivKbd::DictionaryCache::find(const QString &language) {
+    QMutexLocker locker(&mMutex);
+    std::shared_ptr<const Dictionary> *dictionary = mCache.object(language);
+    return dictionary != nullptr ? *dictionary : nullptr;
+}
+
+std::shared_ptr<const UnivKbd::Dictionary> UnivKbd::DictionaryCache::load(const QString &language) {
+    {
+        QMutexLocker locker(&mMutex);
+        std::shared_ptr<const Dictionary> *cached = mCache.object(language);
+        if (cached != nullptr) {
+            return *cached;
+        }
+        if (mMissingLanguages.contains(language)) {
+            return nullptr;
+        }
+    }
+
+    // the lock is not held while loading, so that the dictionaries in memory stay available meanwhile
+    bool success = false;
+    auto dictionary = std::make_shared<const Dictionary>(Dictionary::fromFile(dictionaryPath(language), &success));
+
+    QMutexLocker locker(&mMutex);
+    if (!success) {
+        mMissingLanguages.insert(language);
+        return nullptr;
+    }
+
+    // another thread may have loaded the same dictionary in the meantime
+    std::shared_ptr<const Dictionary> *cached = mCache.object(language);
+    if (cached != nullptr) {
+        return *cached;
+    }
+
+    int cost = int(std::max<qint64>(1, (dictionary->memoryUsage() + 1023) / 1024));
+    mCache.insert(language, new std::shared_ptr<const Dictionary>(dictionary), cost);
+    return dictionary;
+}
+
+void UnivKbd::DictionaryCache::setMaxMemory(qint64 bytes) {
+    QMutexLocker locker(&mMutex);
+    mCache.setMaxCost(int(std::max<qint64>(0, bytes / 1024)));
+}
+
+qint64 UnivKbd::DictionaryCache::maxMemory() const {
+    QMutexLocker locker(&mMutex);
+    return qint64(mCache.maxCost()) * 1024;
+}
+
+qint64 UnivKbd::DictionaryCache::memoryUsage() const {
+    QMutexLocker locker(&mMutex);
+    return qint64(mCache.totalCost()) * 1024;
+}
+
+void UnivKbd::DictionaryCache::clear() {
+    QMutexLocker locker(&mMutex);
+    mCache.clear();
+    mMissingLanguages.clear();
+}
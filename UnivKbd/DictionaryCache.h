@@ -0,0 +1,133 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+#ifndef UNIVKBD_DICTIONARYCACHE_H
+#define UNIVKBD_DICTIONARYCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+#include <memory>
+
+#include "Dictionary.h"
+
+namespace UnivKbd {
+
+    /**
+     * @class DictionaryCache
+     *
+     * @brief Loads the dictionary of each language on demand, and keeps the recently used ones in memory.
+     *
+     * The dictionary of a language is loaded from the resource ":/<language>.dict" the first time it is requested.
+     * When the dictionaries in memory exceed the memory limit, the least recently used ones are released. A released
+     * dictionary stays valid as long as it is in use, since the cache only holds a shared reference to it.
+     *
+     * All the methods are thread-safe, so dictionaries can be loaded from a worker thread.
+     */
+    class DictionaryCache {
+    public:
+        /**
+         * @brief The default memory limit of the cache, in bytes.
+         */
+        static constexpr qint64 DefaultMaxMemory = 64 * 1024 * 1024;
+
+        /**
+         * @brief Returns the cache shared by the whole process.
+         */
+        static DictionaryCache &instance();
+
+        /**
+         * @brief Returns the language of the dictionary to use with a keyboard layout.
+         *
+         * The language is looked up in ":/languages.txt", first with the full name of the layout, then with its name
+         * stripped from its variant, like "Russian" for "Russian (Typewriter)" or "Russian - Mnemonic". Layouts that
+         * are not listed use their stripped name as the language.
+         *
+         * @param keyboard The name of the keyboard layout, as listed by Keyboard::listExportedKeyboards().
+         * @return The language of the layout.
+         */
+        static QString languageForKeyboard(const QString &keyboard);
+
+        /**
+         * @brief Returns the path of the dictionary of a language.
+         */
+        static inline QString dictionaryPath(const QString &language) {
+            return ":/" + language + ".dict";
+        }
+
+        /**
+         * @brief Returns the dictionary of a language if it is already in memory, without loading it.
+         *
+         * @param language The language of the dictionary.
+         * @return The dictionary, or nullptr if it is not in memory.
+         */
+        std::shared_ptr<const Dictionary> find(const QString &language);
+
+        /**
+         * @brief Returns the dictionary of a language, loading it if it is not in memory.
+         *
+         * @param language The language of the dictionary.
+         * @return The dictionary, or nullptr if there is no dictionary for this language.
+         */
+        std::shared_ptr<const Dictionary> load(const QString &language);
+
+        /**
+         * @brief Sets the maximum memory used by the dictionaries kept in the cache.
+         *
+         * @param bytes The limit in bytes. The least recently used dictionaries are released to stay below it.
+         */
+        void setMaxMemory(qint64 bytes);
+
+        /**
+         * @brief Returns the maximum memory used by the dictionaries kept in the cache, in bytes.
+         */
+        qint64 maxMemory() const;
+
+        /**
+         * @brief Returns the memory used by the dictionaries kept in the cache, in bytes.
+         */
+        qint64 memoryUsage() const;
+
+        /**
+         * @brief Releases all the dictionaries kept in the cache.
+         */
+        void clear();
+
+    private:
+        DictionaryCache();
+
+        static QHash<QString, QString> loadLanguages(const QString &path);
+
+    private:
+        mutable QMutex mMutex;
+        QCache<QString, std::shared_ptr<const Dictionary>> mCache;  // the cost is in kilobytes
+        QSet<QString> mMissingLanguages;
+    };
+
+}
+
+#endif // UNIVKBD_DICTIONARYCACHE_H
@@ -0,0 +1,73 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "IconCache.h"
+
+#include <QImageReader>
+#include <QPixmapCache>
+
+UnivKbd::IconCache &UnivKbd::IconCache::instance() {
+    static IconCache cache;
+    return cache;
+}
+
+QString UnivKbd::IconCache::iconPath(KeyType type) {
+    return ":/" + QString::number((int)type) + ".svg";
+}
+
+QSize UnivKbd::IconCache::sourceSize(KeyType type) {
+    auto it = mSourceSizes.find((int)type);
+    if (it == mSourceSizes.end()) {
+        // a missing icon is recorded as an invalid size, and not probed again
+        QImageReader reader(iconPath(type));
+        QSize size = reader.canRead() ? reader.size() : QSize();
+        if (size.isEmpty()) {
+            size = QSize();
+        }
+        it = mSourceSizes.insert((int)type, size);
+    }
+    return it.value();
+}
+
+QPixmap UnivKbd::IconCache::icon(KeyType type, qreal height, qreal devicePixelRatio) {
+    QSize source = sourceSize(type);
+    if (!source.isValid() || height <= 0) {
+        return QPixmap();
+    }
+
+    QString cacheKey = QString("univkbd_icon_%1_%2_%3").arg((int)type).arg(height).arg(devicePixelRatio);
+    QPixmap pixmap;
+    if (QPixmapCache::find(cacheKey, &pixmap)) {
+        return pixmap;
+    }
+
+    // the SVG is rendered at the final size, instead of scaling a pixmap rendered at its default size
+    qreal width = height * source.width() / source.height();
+    QImageReader reader(iconPath(type));
+    reader.setScaledSize(QSize(qMax(1, qRound(width * devicePixelRatio)), qMax(1, qRound(height * devicePixelRatio))));
+    pixmap = QPixmap::fromImage(reader.read());
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+
+    QPixmapCache::insert(cacheKey, pixmap);
+    return pixmap;
+}
@@ -0,0 +1,85 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#ifndef UNIVKBD_ICONCACHE_H
+#define UNIVKBD_ICONCACHE_H
+
+#include <QHash>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+
+#include "Key.h"
+
+namespace UnivKbd {
+
+    /**
+     * @class IconCache
+     *
+     * @brief Renders the icons of the special keys, shared by all the buttons and layouts.
+     *
+     * The icon of a key type is the resource ":/<type>.svg". Each icon is rendered once at the size and device pixel
+     * ratio it is painted at, and kept in the QPixmapCache. Whether a type has an icon is probed once, so the types
+     * without one, like the regular keys, never touch the resources again.
+     *
+     * The cache must only be used from the GUI thread.
+     */
+    class IconCache {
+    public:
+        /**
+         * @brief Returns the cache shared by the whole process.
+         */
+        static IconCache &instance();
+
+        /**
+         * @brief Returns true if the keys of a type have an icon.
+         */
+        inline bool hasIcon(KeyType type) {
+            return sourceSize(type).isValid();
+        }
+
+        /**
+         * @brief Returns the icon of a key type rendered at a given size.
+         *
+         * @param type The type of the key.
+         * @param height The height of the icon, in device independent pixels. The width keeps the aspect ratio of
+         * the SVG file.
+         * @param devicePixelRatio The device pixel ratio of the device the icon is painted on.
+         * @return The icon, or a null pixmap if the type has no icon.
+         */
+        QPixmap icon(KeyType type, qreal height, qreal devicePixelRatio);
+
+    private:
+        IconCache() = default;
+
+        static QString iconPath(KeyType type);
+
+        QSize sourceSize(KeyType type);
+
+    private:
+        QHash<int, QSize> mSourceSizes;  // by key type, invalid when the type has no icon
+    };
+
+}
+
+#endif // UNIVKBD_ICONCACHE_H
@@ -26,6 +26,10 @@
 
 #include <QString>
 
+#include <array>
+
+#include "SpecialsTable.h"
+
 namespace UnivKbd {
 
     /**
@@ -103,7 +107,7 @@ namespace UnivKbd {
          * @see KeyType
         */
         Key(const QString& characters, float xSpan = 1, float ySpan = 1) : mType(KeyType::REGULAR), mCharacters(characters), mXSpan(xSpan), mYSpan(ySpan) {
-            mSpecials.resize(characters.size());
+
         }
 
         /**
@@ -134,7 +138,6 @@ namespace UnivKbd {
         inline Key withCharacters(const QString& characters) const {
             Key key = *this;
             key.mCharacters = characters;
-            key.mSpecials.resize(characters.size());
             return key;
         }
 
@@ -143,21 +146,50 @@ namespace UnivKbd {
          *
          * @return The special characters associated to the key. If the key is not regular, it returns an empty string.
          **/
-        inline const QStringList getSpecials(int i) const {
-            if (i >= mSpecials.size()) {
-                return {};
+        inline const QStringList &getSpecials(int i) const {
+            if (i < 0 || i >= (int)mSpecials.size() || mSpecialsTable == nullptr) {
+                return SpecialsTable::emptySpecials();
             }
-            return mSpecials[i];
+            return mSpecialsTable->specials(mSpecials[i]);
         }
 
         /**
          * @brief Set the special characters associated to the key.
          *
-         * @param specials The special characters associated to the key.
-         * @return The key with the new special characters.
+         * Only the first MaxSpecials characters of a key can have special characters.
+         *
+         * @param i The index of the character of the key.
+         * @param table The table holding the special characters, which must be the same for all the characters.
+         * @param index The index of the special characters in the table.
+         * @see SpecialsTable::find
+         **/
+        inline void setSpecials(int i, const SpecialsTable *table, quint16 index) {
+            if (i < 0 || i >= (int)mSpecials.size()) {
+                return;
+            }
+            mSpecialsTable = table;
+            mSpecials[i] = index;
+        }
+
+        /**
+         * @brief Get the table holding the special characters of the key.
+         *
+         * @return The table, or nullptr if the key has no special characters.
          **/
-        inline void setSpecials(int i, const QStringList& specials) {
-            mSpecials[i] = specials;
+        inline const SpecialsTable *getSpecialsTable() const {
+            return mSpecialsTable;
+        }
+
+        /**
+         * @brief Get the index of the special characters of a character of the key in its table.
+         *
+         * @return The index, or SpecialsTable::NoSpecials.
+         **/
+        inline quint16 getSpecialsIndex(int i) const {
+            if (i < 0 || i >= (int)mSpecials.size()) {
+                return SpecialsTable::NoSpecials;
+            }
+            return mSpecials[i];
         }
 
         /**
@@ -218,10 +250,11 @@ namespace UnivKbd {
             file.write((const char*)(&mX), sizeof(float));
             file.write((const char*)(&mY), sizeof(float));
 
-            int mCharactersSize = mCharacters.size();
+            // the size is in bytes, which is how deserialize() has always read it
+            int mCharactersSize = mCharacters.size() * sizeof(ushort);
             file.write((const char*)(&mCharactersSize), sizeof(int));
             if (mCharactersSize > 0) {
-                file.write((char*)mCharacters.utf16(), mCharactersSize * sizeof(uchar));
+                file.write((const char*)mCharacters.utf16(), mCharactersSize);
             }
 
         }
@@ -244,15 +277,12 @@ namespace UnivKbd {
             int mCharactersSize;
             file.read((char*)(&mCharactersSize), sizeof(int));
             if (mCharactersSize > 0) {
-                ushort *mCharactersBuffer = new ushort[mCharactersSize];
-                file.read((char*)mCharactersBuffer, mCharactersSize * sizeof(uchar));
-                // on qt6, use char16_t overload
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-                key.mCharacters = QString::fromUtf16(mCharactersBuffer, mCharactersSize);
-#else
-                key.mCharacters = QString::fromUtf16((char16_t*)mCharactersBuffer, mCharactersSize);
-#endif
-                delete[] mCharactersBuffer;
+                // older files store the number of code units but only wrote that many bytes, the characters
+                // beyond them are lost. The size is read as a number of bytes, a trailing odd byte being the low
+                // byte of the last code unit.
+                key.mCharacters = QString((mCharactersSize + 1) / 2, Qt::Uninitialized);
+                key.mCharacters[key.mCharacters.size() - 1] = QChar(0);
+                file.read((char*)key.mCharacters.data(), mCharactersSize);
             }
             return key;
         }
@@ -264,10 +294,22 @@ namespace UnivKbd {
          * @return The string that can be used for UI.
          **/        
         inline QString toString(int i = 0) const {
-            switch (getType()) {
+            return toString(getType(), getCharacters(), i);
+        }
+
+        /**
+         * @brief Convert a key to a string that can be used for UI.
+         *
+         * @param type The type of the key.
+         * @param characters The characters of the key.
+         * @param i The index of the character to display. If the key is not regular, this parameter is ignored.
+         * @return The string that can be used for UI.
+         **/
+        static inline QString toString(KeyType type, const QString &characters, int i) {
+            switch (type) {
 
                 case KeyType::REGULAR:
-                    return getCharacters()[std::min((int)i, (int)getCharacters().size() - 1)];
+                    return characters[std::min((int)i, (int)characters.size() - 1)];
 
                 case KeyType::SHIFT:
                     return "Shift";
@@ -362,10 +404,21 @@ namespace UnivKbd {
          * @return The Qt key.
          **/
         Qt::Key toQtKey() const {
-            switch (getType()) {
+            return toQtKey(getType(), getCharacters());
+        }
+
+        /**
+         * @brief Convert a key to a Qt key.
+         *
+         * @param type The type of the key.
+         * @param characters The characters of the key.
+         * @return The Qt key.
+         **/
+        static Qt::Key toQtKey(KeyType type, const QString &characters) {
+            switch (type) {
                     
                     case KeyType::REGULAR:
-                        return static_cast<Qt::Key>(getCharacters()[0].unicode());
+                        return static_cast<Qt::Key>(characters[0].unicode());
 
                     case KeyType::SHIFT:
                         return Qt::Key_Shift;
@@ -447,10 +500,31 @@ namespace UnivKbd {
                 }
         }
 
+        /**
+         * @brief The number of characters of a key that can have special characters.
+         */
+        static constexpr int MaxSpecials = 4;
+
+        /**
+         * @brief The number of modifier levels: none, Shift, AltGr and AltGr+Shift.
+         *
+         * The characters of a key are given by level, a key with fewer characters types its last one on the
+         * higher levels.
+         */
+        static constexpr int MaxLevels = 4;
+
+        /**
+         * @brief Returns the modifier level of a combination of modifiers, the index of the character it types.
+         */
+        static constexpr int level(bool shift, bool altGr) {
+            return (shift ? 1 : 0) + (altGr ? 2 : 0);
+        }
+
     private:
         KeyType mType;
         QString mCharacters;
-        QVector<QStringList> mSpecials;
+        const SpecialsTable *mSpecialsTable = nullptr;
+        std::array<quint16, MaxSpecials> mSpecials = {};  // indices in mSpecialsTable
         float mXSpan, mYSpan, mX, mY;
     };
 
@@ -0,0 +1,298 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+#include "Keyboard.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QResource>
+#include <QVector>
+#include <QtEndian>
+
+#include <cstring>
+
+static_assert(sizeof(UnivKbd::KeyboardFileHeader) == 20, "KeyboardFileHeader must match the binary format");
+static_assert(sizeof(UnivKbd::KeyRecord) == 28, "KeyRecord must match the binary format");
+
+namespace {
+
+    quint32 checksum(const uchar *data, qint64 size) {
+        // FNV-1a
+        quint32 hash = 2166136261u;
+        for (qint64 i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    // converts a float between the host and the file byte order, in both directions
+    float toLittleEndian(float value) {
+        quint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = qToLittleEndian(bits);
+        std::memcpy(&value, &bits, sizeof(bits));
+        return value;
+    }
+
+    template<typename T>
+    T readValue(const uchar *data) {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+}
+
+void UnivKbd::Keyboard::serialize(QIODevice &file) const {
+    std::vector<KeyRecord> records;
+    records.reserve(mKeys.size());
+    QVector<quint16> strings;
+    // identical labels are stored once
+    QHash<QString, quint32> offsets;
+
+    for (const auto &key : mKeys) {
+        const QString &characters = key.getCharacters();
+        auto offset = offsets.find(characters);
+        if (offset == offsets.end()) {
+            offset = offsets.insert(characters, (quint32)strings.size());
+            for (QChar character : characters) {
+                strings.append(qToLittleEndian((quint16)character.unicode()));
+            }
+        }
+
+        KeyRecord record;
+        record.type = qToLittleEndian((qint32)key.getType());
+        record.xSpan = toLittleEndian(key.getXSpan());
+        record.ySpan = toLittleEndian(key.getYSpan());
+        record.x = toLittleEndian(key.getX());
+        record.y = toLittleEndian(key.getY());
+        record.charactersOffset = qToLittleEndian(offset.value());
+        record.charactersSize = qToLittleEndian((quint32)characters.size());
+        records.push_back(record);
+    }
+
+    QByteArray body;
+    body.append((const char*)records.data(), (int)(records.size() * sizeof(KeyRecord)));
+    body.append((const char*)strings.constData(), (int)(strings.size() * sizeof(quint16)));
+
+    KeyboardFileHeader header;
+    std::memcpy(header.magic, "UKKB", 4);
+    header.version = qToLittleEndian<quint32>(2);
+    header.checksum = qToLittleEndian(checksum((const uchar*)body.constData(), body.size()));
+    header.keyCount = qToLittleEndian((quint32)records.size());
+    header.stringTableSize = qToLittleEndian((quint32)strings.size());
+
+    file.write((const char*)&header, sizeof(header));
+    file.write(body);
+}
+
+bool UnivKbd::Keyboard::deserialize(QFile &file) {
+    mKeys.clear();
+
+    if (file.peek(4) != "UKKB") {
+        // version 1, made of the number of keys followed by the keys
+        int size;
+        if (file.read((char*)(&size), sizeof(int)) != (qint64)sizeof(int) || size < 0) {
+            return false;
+        }
+        mKeys.resize(size);
+        for (int i = 0; i < size; ++i) {
+            mKeys[i] = Key::deserialize(file);
+        }
+        return true;
+    }
+
+    QByteArray data = file.read(sizeof(KeyboardFileHeader));
+    if (data.size() != (int)sizeof(KeyboardFileHeader)) {
+        return false;
+    }
+    KeyboardFileHeader header = readValue<KeyboardFileHeader>((const uchar*)data.constData());
+    qint64 bodySize = (qint64)qFromLittleEndian(header.keyCount) * (qint64)sizeof(KeyRecord)
+            + (qint64)qFromLittleEndian(header.stringTableSize) * (qint64)sizeof(quint16);
+    data += file.read(bodySize);
+
+    // the data does not outlive this call, so the characters are copied
+    bool ok = false;
+    *this = decode((const uchar*)data.constData(), data.size(), false, &ok);
+    return ok;
+}
+
+UnivKbd::Keyboard UnivKbd::Keyboard::fromData(const uchar *data, qint64 size, bool *ok) {
+    return decode(data, size, true, ok);
+}
+
+UnivKbd::Keyboard UnivKbd::Keyboard::fromFile(const QString &path, bool *ok) {
+    QResource resource(path);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    bool isCompressed = resource.compressionAlgorithm() != QResource::NoCompression;
+#else
+    bool isCompressed = resource.isCompressed();
+#endif
+    if (resource.isValid() && !isCompressed && resource.data() != nullptr) {
+        // resources live as long as the application, the keyboard can point into them
+        return fromData(resource.data(), resource.size(), ok);
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (ok != nullptr) {
+            *ok = false;
+        }
+        return Keyboard();
+    }
+    QByteArray data = file.readAll();
+    return decode((const uchar*)data.constData(), data.size(), false, ok);
+}
+
+UnivKbd::Keyboard UnivKbd::Keyboard::decode(const uchar *data, qint64 size, bool view, bool *ok) {
+    if (ok != nullptr) {
+        *ok = false;
+    }
+
+    if (size < 4 || std::memcmp(data, "UKKB", 4) != 0) {
+        return decodeVersion1(data, size, ok);
+    }
+
+    if (size < (qint64)sizeof(KeyboardFileHeader)) {
+        return Keyboard();
+    }
+    KeyboardFileHeader header = readValue<KeyboardFileHeader>(data);
+    if (qFromLittleEndian(header.version) != 2) {
+        qDebug() << "Unsupported keyboard version" << qFromLittleEndian(header.version);
+        return Keyboard();
+    }
+
+    quint32 keyCount = qFromLittleEndian(header.keyCount);
+    quint32 stringTableSize = qFromLittleEndian(header.stringTableSize);
+    qint64 recordsSize = (qint64)keyCount * (qint64)sizeof(KeyRecord);
+    qint64 bodySize = recordsSize + (qint64)stringTableSize * (qint64)sizeof(quint16);
+    if (size - (qint64)sizeof(KeyboardFileHeader) < bodySize) {
+        qDebug() << "Truncated keyboard";
+        return Keyboard();
+    }
+
+    const uchar *body = data + sizeof(KeyboardFileHeader);
+    if (checksum(body, bodySize) != qFromLittleEndian(header.checksum)) {
+        qDebug() << "Corrupted keyboard";
+        return Keyboard();
+    }
+
+    const uchar *strings = body + recordsSize;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    view = view && (quintptr)strings % alignof(QChar) == 0;
+#else
+    view = false;
+#endif
+
+    Keyboard keyboard;
+    keyboard.mKeys.reserve(keyCount);
+    for (quint32 i = 0; i < keyCount; i++) {
+        KeyRecord record = readValue<KeyRecord>(body + i * sizeof(KeyRecord));
+        quint32 offset = qFromLittleEndian(record.charactersOffset);
+        quint32 length = qFromLittleEndian(record.charactersSize);
+        if ((quint64)offset + length > stringTableSize) {
+            qDebug() << "Corrupted keyboard";
+            return Keyboard();
+        }
+
+        QString characters;
+        if (view) {
+            characters = QString::fromRawData((const QChar*)(strings + offset * sizeof(quint16)), (int)length);
+        } else {
+            characters.resize((int)length);
+            for (quint32 j = 0; j < length; j++) {
+                characters[(int)j] = QChar(qFromLittleEndian(readValue<quint16>(strings + (offset + j) * sizeof(quint16))));
+            }
+        }
+
+        Key key((KeyType)qFromLittleEndian(record.type), toLittleEndian(record.xSpan), toLittleEndian(record.ySpan));
+        if (length > 0) {
+            key = key.withCharacters(characters);
+        }
+        key.setX(toLittleEndian(record.x));
+        key.setY(toLittleEndian(record.y));
+        keyboard.mKeys.push_back(key);
+    }
+
+    if (ok != nullptr) {
+        *ok = true;
+    }
+    return keyboard;
+}
+
+UnivKbd::Keyboard UnivKbd::Keyboard::decodeVersion1(const uchar *data, qint64 size, bool *ok) {
+    // number of keys, then for each key: type, x span, y span, x, y, and the size of the characters followed by them
+    const qint64 keyHeaderSize = sizeof(qint32) + 4 * sizeof(float) + sizeof(qint32);
+
+    if (size < (qint64)sizeof(qint32)) {
+        return Keyboard();
+    }
+    qint32 keyCount = qFromLittleEndian(readValue<qint32>(data));
+    if (keyCount < 0) {
+        return Keyboard();
+    }
+
+    Keyboard keyboard;
+    qint64 position = sizeof(qint32);
+    for (qint32 i = 0; i < keyCount; i++) {
+        if (size - position < keyHeaderSize) {
+            qDebug() << "Truncated keyboard";
+            return Keyboard();
+        }
+
+        const uchar *keyData = data + position;
+        KeyType type = (KeyType)qFromLittleEndian(readValue<qint32>(keyData));
+        float xSpan = toLittleEndian(readValue<float>(keyData + 4));
+        float ySpan = toLittleEndian(readValue<float>(keyData + 8));
+        float x = toLittleEndian(readValue<float>(keyData + 12));
+        float y = toLittleEndian(readValue<float>(keyData + 16));
+        qint32 charactersSize = qFromLittleEndian(readValue<qint32>(keyData + 20));
+        position += keyHeaderSize;
+
+        // the size is a number of bytes, see Key::deserialize
+        if (charactersSize < 0 || size - position < charactersSize) {
+            qDebug() << "Truncated keyboard";
+            return Keyboard();
+        }
+        QString characters((charactersSize + 1) / 2, QChar(0));
+        for (qint32 j = 0; j < charactersSize; j++) {
+            ushort unit = characters[j / 2].unicode() | (ushort)(data[position + j] << (8 * (j % 2)));
+            characters[j / 2] = QChar(unit);
+        }
+        position += charactersSize;
+
+        Key key(type, xSpan, ySpan);
+        if (charactersSize > 0) {
+            key = key.withCharacters(characters);
+        }
+        key.setX(x);
+        key.setY(y);
+        keyboard.mKeys.push_back(key);
+    }
+
+    if (ok != nullptr) {
+        *ok = true;
+    }
+    return keyboard;
+}
@@ -31,6 +31,8 @@
 #include <QDebug>
 
 #include "Key.h"
+#include "CharacterRemap.h"
+#include "StringPool.h"
 
 /**
  * @brief Internal function to initializes the UnivKbd Qt resources.
@@ -38,6 +40,7 @@
 inline void UNIVKBD_INIT_RESOURCE() {
     Q_INIT_RESOURCE(keyboards);
     Q_INIT_RESOURCE(icons);
+    Q_INIT_RESOURCE(dictionaries);
 }
 
 namespace UnivKbd {
@@ -54,6 +57,90 @@ namespace UnivKbd {
         return layouts;
     }
 
+    /**
+     * @brief The header of a keyboard in the version 2 of the .keyboard format.
+     *
+     * The header is followed by keyCount key records, then by the UTF-16 string table holding the characters of
+     * all the keys, in little-endian byte order. The checksum covers everything after the header, so that a
+     * truncated or corrupted file is rejected instead of producing garbage keys.
+     *
+     * Files of the version 1 have no header, and start with the number of keys.
+     *
+     * @see Keyboard::serialize
+     */
+    struct KeyboardFileHeader {
+        char magic[4];             ///< Always "UKKB".
+        quint32 version;           ///< The version of the format, currently 2.
+        quint32 checksum;          ///< FNV-1a hash of the key records and the string table.
+        quint32 keyCount;          ///< The number of key records following the header.
+        quint32 stringTableSize;   ///< The number of UTF-16 code units of the string table.
+    };
+
+    /**
+     * @brief A key of a keyboard in the version 2 of the .keyboard format.
+     */
+    struct KeyRecord {
+        qint32 type;                ///< The KeyType of the key.
+        float xSpan;                ///< The width of the key.
+        float ySpan;                ///< The height of the key.
+        float x;                    ///< The x position of the key.
+        float y;                    ///< The y position of the key.
+        quint32 charactersOffset;   ///< The offset of the characters of the key in the string table, in code units.
+        quint32 charactersSize;     ///< The number of code units of the characters of the key.
+    };
+
+    /**
+     * @brief A string of the table of the layouts compiled into the library.
+     */
+    struct StaticString {
+        quint32 offset;  ///< The offset of the string in StaticKeyboardTable::strings, in code units.
+        quint32 size;    ///< The number of code units of the string.
+    };
+
+    /**
+     * @brief A key of a layout compiled into the library.
+     */
+    struct StaticKey {
+        KeyType type;            ///< The type of the key.
+        float xSpan;             ///< The width of the key.
+        float ySpan;             ///< The height of the key.
+        float x;                 ///< The x position of the key.
+        float y;                 ///< The y position of the key.
+        StaticString characters; ///< The characters of the key.
+    };
+
+    /**
+     * @brief A layout compiled into the library.
+     */
+    struct StaticKeyboard {
+        StaticString name;       ///< The name of the layout.
+        const StaticKey *keys;   ///< The keys of the layout.
+        quint32 keyCount;        ///< The number of keys.
+    };
+
+    /**
+     * @brief The special characters of a character, compiled into the library from specials.txt.
+     */
+    struct StaticSpecials {
+        char16_t character;      ///< The character.
+        quint32 first;           ///< The index of the first special character in StaticKeyboardTable::specialStrings.
+        quint32 count;           ///< The number of special characters.
+    };
+
+    /**
+     * @brief The layouts and special characters compiled into the library.
+     *
+     * The table is generated at build time from the keyboards directory by tools/KeyboardTableGenerator.cpp.
+     */
+    struct StaticKeyboardTable {
+        const char16_t *strings;              ///< The UTF-16 characters of all the strings.
+        const StaticKeyboard *keyboards;      ///< The layouts, sorted by name.
+        quint32 keyboardCount;                ///< The number of layouts.
+        const StaticSpecials *specials;       ///< The special characters, sorted by character.
+        quint32 specialsCount;                ///< The number of characters having special characters.
+        const StaticString *specialStrings;   ///< The special characters referenced by specials.
+    };
+
     /**
      * @class Keyboard
      *
@@ -72,34 +159,91 @@ namespace UnivKbd {
         }
 
         /**
-         * @brief Serializes the keyboard into a file.
+         * @brief Serializes the keyboard into a file, in the version 2 of the .keyboard format.
          *
-         * @param file The file to serialize the keyboard into.
+         * @param file The file, or any other device, to serialize the keyboard into.
          * 
          * @note You can serialize multiple keyboards into the same file.
+         * @see KeyboardFileHeader
          */
-        inline void serialize(QFile &file) {
-            int size = mKeys.size();
-            file.write((char*)(&size), sizeof(int));
-            for (int i = 0; i < size; ++i) {
-                mKeys[i].serialize(file);
-            }
-        }
+        void serialize(QIODevice &file) const;
 
         /**
-         * @brief Deserializes the keyboard from a file.
+         * @brief Deserializes the keyboard from a file, in the version 1 or 2 of the .keyboard format.
          *
          * @param file The file to deserialize the keyboard from.
+         * @return False if the keyboard could not be read, in which case the keyboard is left empty.
          * 
          * @note You can deserialize mutliple keyboards from a same file.
          */
-        inline void deserialize(QFile &file) {
-            int size;
-            file.read((char*)(&size), sizeof(int));
-            mKeys.resize(size);
-            for (int i = 0; i < size; ++i) {
-                mKeys[i] = Key::deserialize(file);
-            }
+        bool deserialize(QFile &file);
+
+        /**
+         * @brief Returns a keyboard viewing serialized data in place.
+         *
+         * The characters of the keys of a keyboard in the version 2 of the format point into the data instead of
+         * being copied, so the data must outlive the keyboard and every copy of its keys. This is the case of the
+         * uncompressed Qt resources, and of files mapped for the lifetime of the application.
+         *
+         * @param data The serialized keyboard, in the version 1 or 2 of the .keyboard format.
+         * @param size The size of the data in bytes.
+         * @param ok If not null, set to false when the data is not a valid keyboard.
+         * @return The keyboard.
+         */
+        static Keyboard fromData(const uchar *data, qint64 size, bool *ok = nullptr);
+
+        /**
+         * @brief Loads a keyboard from a file.
+         *
+         * Uncompressed resources are viewed in place with fromData(), other files are read in memory.
+         *
+         * @param path The path of the file, in the version 1 or 2 of the .keyboard format.
+         * @param ok If not null, set to false when the file could not be read or is not a valid keyboard.
+         * @return The keyboard.
+         */
+        static Keyboard fromFile(const QString &path, bool *ok = nullptr);
+
+        /**
+         * @brief Constructs a keyboard from a layout compiled into the library.
+         *
+         * The characters of the keys point into the static storage, so no file is read and nothing is parsed.
+         * The special characters are not applied, see applyStaticSpecials().
+         *
+         * @param keyboard The layout, found with findStaticKeyboard().
+         */
+        explicit Keyboard(const StaticKeyboard &keyboard);
+
+        /**
+         * @brief Returns the layouts and special characters compiled into the library.
+         */
+        static const StaticKeyboardTable &staticKeyboards();
+
+        /**
+         * @brief Returns the layout compiled into the library with the given name.
+         *
+         * @param name The name of the layout.
+         * @return The layout, or nullptr if there is none with this name.
+         */
+        static const StaticKeyboard *findStaticKeyboard(const QString &name);
+
+        /**
+         * @brief Returns the names of the layouts compiled into the library, sorted.
+         */
+        static QStringList staticKeyboardNames();
+
+        /**
+         * @brief Returns the special characters compiled into the library from the default specials file.
+         *
+         * The table is built once, its strings point into the static storage.
+         */
+        static const SpecialsTable &staticSpecials();
+
+        /**
+         * @brief Applies the special characters compiled into the library to the keys, like loadSpecials() does
+         * with the default specials file.
+         */
+        inline void applyStaticSpecials() {
+            applySpecials(staticSpecials());
         }
 
         /**
@@ -151,12 +295,15 @@ namespace UnivKbd {
         /**
          * @brief Lists the exported keyboards.
          *
-         * @param path The path to look at for keyboards
+         * @param path The path to look at for keyboards. At ":/", the keyboards are the layouts compiled into the
+         * library.
          * @return A list of exported keyboards.
          */
         static inline QList<QString> listExportedKeyboards(QString path=":/") {
-            // initialize keyboards resources
-            UNIVKBD_INIT_RESOURCE();
+            if (path == ":/") {
+                return staticKeyboardNames();
+            }
+
             QDir dir(path);
             if (!dir.exists()) {
                 return QList<QString>();
@@ -170,36 +317,34 @@ namespace UnivKbd {
         }
 
         /**
-         * @brief Imports a keyboard from a file.
+         * @brief Imports a keyboard compiled into the library.
          *
          * @param name The name of the keyboard.
          * @param layout The layout of the keyboard.
          * @return Keyboard The imported keyboard.
          */
         static inline Keyboard importKeyboard(const QString &name, const QString &layout) {
-            QFile file(":/" + name + ".keyboard");
-            file.open(QIODevice::ReadOnly);
-            if (!file.isOpen()) {
+            const StaticKeyboard *staticKeyboard = findStaticKeyboard(name);
+            if (staticKeyboard == nullptr) {
                 qDebug() << "Could not open keyboard" << name;
                 return Keyboard();
             }
-            Keyboard keyboard;
-            keyboard.deserialize(file);
-            file.close();
-            qDebug() << "Converting imported keyboard" << name << "from" << getKeyboardLayouts()[0] << "to" << layout;
-            keyboard = convertLayout(keyboard, getKeyboardLayouts()[0], layout);
-            keyboard.loadSpecials();
+            Keyboard keyboard(*staticKeyboard);
+            // the layouts are stored in the first layout, there is nothing to convert to it
+            if (layout != getKeyboardLayouts()[0]) {
+                qDebug() << "Converting imported keyboard" << name << "from" << getKeyboardLayouts()[0] << "to" << layout;
+                keyboard = convertLayout(keyboard, getKeyboardLayouts()[0], layout);
+            }
+            keyboard.internLabels();
+            keyboard.applyStaticSpecials();
             return keyboard;
         }
 
         static QString convertLayout(const QString &text, const std::map<QChar, QChar> &charMap) {
-            QString convertedText = "";
+            QString convertedText(text.size(), Qt::Uninitialized);
             for (int i = 0; i < text.size(); i++) {
-                if (charMap.find(text.at(i)) != charMap.end()) {
-                    convertedText += charMap.at(text.at(i));
-                } else {
-                    convertedText += text.at(i);
-                }
+                auto it = charMap.find(text.at(i));
+                convertedText[i] = it != charMap.end() ? it->second : text.at(i);
             }
             return convertedText;
         }
@@ -216,54 +361,69 @@ namespace UnivKbd {
             return convertedKeyboard;
         }
 
-        static Keyboard convertLayout(Keyboard &keyboard, const QString &from, const QString &to) {
-            // create a QChar map from inputLayout to outputLayout
-            std::map<QChar, QChar> charMap;
-            for (int i = 0; i < from.size(); i++) {
-                charMap[from.at(i)] = to.at(i);
-                charMap[QChar(from.at(i)).toUpper()] = QChar(to.at(i)).toUpper();
+        /**
+         * @brief Converts the characters of the keys of a keyboard in a single pass.
+         *
+         * @param keyboard The keyboard to convert.
+         * @param remap The characters to replace.
+         * @return The converted keyboard. The keys whose characters are not remapped share them with keyboard.
+         */
+        static Keyboard convertLayout(const Keyboard &keyboard, const CharacterRemap &remap) {
+            Keyboard convertedKeyboard;
+            convertedKeyboard.mKeys.reserve(keyboard.mKeys.size());
+            for (const auto &key : keyboard.mKeys) {
+                if (key.getType() == KeyType::REGULAR) {
+                    convertedKeyboard.mKeys.push_back(key.withCharacters(remap.map(key.getCharacters())));
+                } else {
+                    convertedKeyboard.mKeys.push_back(key);
+                }
             }
-            return convertLayout(keyboard, charMap);
+            return convertedKeyboard;
+        }
+
+        static Keyboard convertLayout(Keyboard &keyboard, const QString &from, const QString &to) {
+            // the remap table between two layouts is built once and reused
+            return convertLayout(keyboard, *CharacterRemap::forLayouts(from, to));
         }
 
         void loadSpecials(QString path = ":/specials.txt") {
-            QFile file(path);
-            file.open(QIODevice::ReadOnly);
-            if (!file.isOpen()) {
-                qDebug() << "Could not open specials file";
-                return;
-            }
-            /* File format :
-            a : à, â, ä, æ, ã, å, ā, ą, α (alpha)
-            b : ß, β (bêta)
-            c : ç, ć, č, ĉ, ċ, χ (chi)
-             */
-            std::map<QChar, QStringList> mSpecials;
-            while (!file.atEnd()) {
-                QString line = file.readLine();
-                QStringList parts = line.split(":");
-                if (parts.size() != 2) {
-                    continue;
-                }
-                QString key = parts[0].trimmed();
-                QStringList values = parts[1].split(",");
-                for (int i = 0; i < values.size(); i++) {
-                    values[i] = values[i].trimmed();
+            // the file is parsed once, then its table is shared by all the keyboards
+            applySpecials(*SpecialsTable::fromFile(path));
+        }
+
+        /**
+         * @brief Replaces the characters of the keys by their copy in the StringPool, shared by all the keyboards.
+         */
+        inline void internLabels() {
+            StringPool &pool = StringPool::instance();
+            for (auto &key : mKeys) {
+                if (key.getType() == KeyType::REGULAR) {
+                    key = key.withCharacters(pool.intern(key.getCharacters()));
                 }
-                mSpecials[key.at(0)] = values;
             }
+        }
 
-            // apply specials to keys
-            for (std::vector<Key>::size_type i = 0; i < mKeys.size(); i++) {
-                Key &key = mKeys[i];
+        /**
+         * @brief Makes the keys refer to their special characters in a table.
+         *
+         * Only the first Key::MaxSpecials characters of a key, the ones typed with a modifier level, get their
+         * special characters. The special characters of the other characters are dropped, the keyboard table
+         * generator warns about them when the layouts are compiled.
+         *
+         * @param table The table, which must outlive the keys.
+         */
+        inline void applySpecials(const SpecialsTable &table) {
+            for (auto &key : mKeys) {
                 if (key.getType() != KeyType::REGULAR) {
                     continue;
                 }
-                QString characters = key.getCharacters();
-                for (int j = 0; j < characters.size(); j++) {
-                    if (mSpecials.find(characters.at(j)) != mSpecials.end()) {
-                        key.setSpecials(j, mSpecials[characters.at(j)]);
+                const QString &characters = key.getCharacters();
+                for (int j = 0; j < (int)characters.size() && j < Key::MaxSpecials; j++) {
+                    quint16 index = table.find(characters.at(j));
+                    if (index == SpecialsTable::NoSpecials) {
+                        continue;
                     }
+                    key.setSpecials(j, &table, index);
                 }
             }
         }
@@ -271,6 +431,11 @@ namespace UnivKbd {
     protected:
         Keyboard() = default;
 
+    private:
+        static Keyboard decode(const uchar *data, qint64 size, bool view, bool *ok);
+
+        static Keyboard decodeVersion1(const uchar *data, qint64 size, bool *ok);
+
     private:
         std::vector<Key> mKeys;
     };
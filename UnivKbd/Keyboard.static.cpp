@@ -0,0 +1,90 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "Keyboard.h"
+
+#include <algorithm>
+
+namespace {
+
+    QString staticString(const UnivKbd::StaticKeyboardTable &table, const UnivKbd::StaticString &string) {
+        return QString::fromRawData(reinterpret_cast<const QChar*>(table.strings + string.offset), (int)string.size);
+    }
+
+}
+
+UnivKbd::Keyboard::Keyboard(const StaticKeyboard &keyboard) {
+    const StaticKeyboardTable &table = staticKeyboards();
+
+    mKeys.reserve(keyboard.keyCount);
+    for (quint32 i = 0; i < keyboard.keyCount; i++) {
+        const StaticKey &staticKey = keyboard.keys[i];
+        Key key(staticKey.type, staticKey.xSpan, staticKey.ySpan);
+        if (staticKey.characters.size > 0) {
+            key = key.withCharacters(staticString(table, staticKey.characters));
+        }
+        key.setX(staticKey.x);
+        key.setY(staticKey.y);
+        mKeys.push_back(key);
+    }
+}
+
+const UnivKbd::StaticKeyboard *UnivKbd::Keyboard::findStaticKeyboard(const QString &name) {
+    const StaticKeyboardTable &table = staticKeyboards();
+    const StaticKeyboard *end = table.keyboards + table.keyboardCount;
+
+    // the layouts are sorted by name when the table is generated
+    const StaticKeyboard *keyboard = std::lower_bound(table.keyboards, end, name, [&](const StaticKeyboard &candidate, const QString &value) {
+        return staticString(table, candidate.name) < value;
+    });
+    if (keyboard == end || staticString(table, keyboard->name) != name) {
+        return nullptr;
+    }
+    return keyboard;
+}
+
+QStringList UnivKbd::Keyboard::staticKeyboardNames() {
+    const StaticKeyboardTable &table = staticKeyboards();
+    QStringList names;
+    names.reserve((int)table.keyboardCount);
+    for (quint32 i = 0; i < table.keyboardCount; i++) {
+        names << staticString(table, table.keyboards[i].name);
+    }
+    return names;
+}
+
+const UnivKbd::SpecialsTable &UnivKbd::Keyboard::staticSpecials() {
+    static const SpecialsTable specials = []() {
+        const StaticKeyboardTable &table = staticKeyboards();
+        std::map<QChar, QStringList> values;
+        for (quint32 i = 0; i < table.specialsCount; i++) {
+            const StaticSpecials &special = table.specials[i];
+            QStringList &list = values[QChar(special.character)];
+            for (quint32 j = 0; j < special.count; j++) {
+                list << staticString(table, table.specialStrings[special.first + j]);
+            }
+        }
+        return SpecialsTable(values);
+    }();
+    return specials;
+}
@@ -0,0 +1,85 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "KeyboardCache.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+UnivKbd::KeyboardCache &UnivKbd::KeyboardCache::instance() {
+    static KeyboardCache cache;
+    return cache;
+}
+
+UnivKbd::KeyboardCache::KeyboardCache() {
+    setMaxKeyboards(DefaultMaxKeyboards);
+}
+
+std::shared_ptr<const UnivKbd::Keyboard> UnivKbd::KeyboardCache::load(const QString &name, const QString &layout) {
+    QPair<QString, QString> key(name, layout);
+    {
+        QMutexLocker locker(&mMutex);
+        std::shared_ptr<const Keyboard> *cached = mCache.object(key);
+        if (cached != nullptr) {
+            return *cached;
+        }
+    }
+
+    // the lock is not held while importing, so that the keyboards in memory stay available meanwhile
+    auto keyboard = std::make_shared<const Keyboard>(Keyboard::importKeyboard(name, layout));
+    if (keyboard->getKeys().empty()) {
+        return nullptr;
+    }
+
+    QMutexLocker locker(&mMutex);
+
+    // another thread may have imported the same keyboard in the meantime
+    std::shared_ptr<const Keyboard> *cached = mCache.object(key);
+    if (cached != nullptr) {
+        return *cached;
+    }
+
+    mCache.insert(key, new std::shared_ptr<const Keyboard>(keyboard));
+    return keyboard;
+}
+
+void UnivKbd::KeyboardCache::setMaxKeyboards(int count) {
+    QMutexLocker locker(&mMutex);
+    mCache.setMaxCost(std::max(0, count));
+}
+
+int UnivKbd::KeyboardCache::maxKeyboards() const {
+    QMutexLocker locker(&mMutex);
+    return mCache.maxCost();
+}
+
+int UnivKbd::KeyboardCache::size() const {
+    QMutexLocker locker(&mMutex);
+    return mCache.size();
+}
+
+void UnivKbd::KeyboardCache::clear() {
+    QMutexLocker locker(&mMutex);
+    mCache.clear();
+}
@@ -0,0 +1,104 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#ifndef UNIVKBD_KEYBOARDCACHE_H
+#define UNIVKBD_KEYBOARDCACHE_H
+
+#include <QCache>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+#include <memory>
+
+#include "Keyboard.h"
+
+namespace UnivKbd {
+
+    /**
+     * @class KeyboardCache
+     *
+     * @brief Keeps the recently imported keyboards in memory, converted to their layout and with their special
+     * characters applied.
+     *
+     * Switching back to a keyboard used recently then returns the same immutable keyboard, without importing and
+     * converting it again. When the cache exceeds its limit, the least recently used keyboards are released. A
+     * released keyboard stays valid as long as it is in use, since the cache only holds a shared reference to it.
+     *
+     * All the methods are thread-safe.
+     */
+    class KeyboardCache {
+    public:
+        /**
+         * @brief The default maximum number of keyboards kept in the cache.
+         */
+        static constexpr int DefaultMaxKeyboards = 16;
+
+        /**
+         * @brief Returns the cache shared by the whole process.
+         */
+        static KeyboardCache &instance();
+
+        /**
+         * @brief Returns a keyboard, importing it if it is not in memory.
+         *
+         * @param name The name of the keyboard, as listed by Keyboard::listExportedKeyboards().
+         * @param layout The layout to convert the keyboard to.
+         * @return The keyboard, or nullptr if it could not be imported.
+         * @see Keyboard::importKeyboard
+         */
+        std::shared_ptr<const Keyboard> load(const QString &name, const QString &layout);
+
+        /**
+         * @brief Sets the maximum number of keyboards kept in the cache.
+         *
+         * @param count The limit. The least recently used keyboards are released to stay below it.
+         */
+        void setMaxKeyboards(int count);
+
+        /**
+         * @brief Returns the maximum number of keyboards kept in the cache.
+         */
+        int maxKeyboards() const;
+
+        /**
+         * @brief Returns the number of keyboards kept in the cache.
+         */
+        int size() const;
+
+        /**
+         * @brief Releases all the keyboards kept in the cache.
+         */
+        void clear();
+
+    private:
+        KeyboardCache();
+
+    private:
+        mutable QMutex mMutex;
+        QCache<QPair<QString, QString>, std::shared_ptr<const Keyboard>> mCache;
+    };
+
+}
+
+#endif // UNIVKBD_KEYBOARDCACHE_H
@@ -0,0 +1,143 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "KeyboardModel.h"
+#include "StringPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+UnivKbd::KeyboardModel::KeyboardModel(const Keyboard &keyboard) {
+    const std::vector<Key> &keys = keyboard.getKeys();
+
+    int labelsSize = 0;
+    for (const auto &key : keys) {
+        labelsSize += key.getCharacters().size();
+    }
+
+    mTypes.reserve(keys.size());
+    mX.reserve(keys.size());
+    mY.reserve(keys.size());
+    mXSpan.reserve(keys.size());
+    mYSpan.reserve(keys.size());
+    mLabelOffsets.reserve(keys.size() + 1);
+    mSpecials.reserve(keys.size());
+    mLabels.reserve(labelsSize);
+
+    for (const auto &key : keys) {
+        mTypes.push_back(key.getType());
+        mX.push_back(key.getX());
+        mY.push_back(key.getY());
+        mXSpan.push_back(key.getXSpan());
+        mYSpan.push_back(key.getYSpan());
+        mLabelOffsets.push_back(quint32(mLabels.size()));
+        mLabels += key.getCharacters();
+
+        std::array<quint16, Key::MaxSpecials> specials;
+        for (int i = 0; i < Key::MaxSpecials; i++) {
+            specials[i] = key.getSpecialsIndex(i);
+        }
+        mSpecials.push_back(specials);
+        if (key.getSpecialsTable() != nullptr) {
+            // the keys of a keyboard share the same table
+            mSpecialsTable = key.getSpecialsTable();
+        }
+    }
+    mLabelOffsets.push_back(quint32(mLabels.size()));
+
+    // the labels are built here once, instead of on every modifier change, and most of them, like the names of
+    // the special keys and the letters of the latin layouts, are shared by all the keyboards
+    StringPool &pool = StringPool::instance();
+    mLevelLabels.reserve(size_t(size()) * Key::MaxLevels);
+    for (int i = 0; i < size(); i++) {
+        QString characters = this->characters(i);
+        for (int level = 0; level < Key::MaxLevels; level++) {
+            mLevelLabels.push_back(characters.isEmpty() && mTypes[i] == KeyType::REGULAR ? QString() :
+                                   pool.intern(Key::toString(mTypes[i], characters, level)));
+        }
+    }
+
+    for (int i = 0; i < size(); i++) {
+        mWidth = std::max(mWidth, mX[i] + mXSpan[i]);
+        mHeight = std::max(mHeight, mY[i] + mYSpan[i]);
+    }
+    buildGrid();
+}
+
+void UnivKbd::KeyboardModel::cellRange(int index, int &firstColumn, int &lastColumn, int &firstRow, int &lastRow) const {
+    firstColumn = std::max(0, int(std::floor(mX[index] * GridResolution)));
+    lastColumn = std::min(mGridColumns, int(std::ceil((mX[index] + mXSpan[index]) * GridResolution)));
+    firstRow = std::max(0, int(std::floor(mY[index] * GridResolution)));
+    lastRow = std::min(mGridRows, int(std::ceil((mY[index] + mYSpan[index]) * GridResolution)));
+}
+
+void UnivKbd::KeyboardModel::buildGrid() {
+    mGridColumns = int(std::ceil(mWidth * GridResolution));
+    mGridRows = int(std::ceil(mHeight * GridResolution));
+    mGridCells.assign(size_t(mGridColumns) * size_t(mGridRows) + 1, 0);
+
+    // count the keys of each cell, then fill them in, so that the keys of all the cells are in a single array
+    int firstColumn, lastColumn, firstRow, lastRow;
+    for (int i = 0; i < size(); i++) {
+        cellRange(i, firstColumn, lastColumn, firstRow, lastRow);
+        for (int row = firstRow; row < lastRow; row++) {
+            for (int column = firstColumn; column < lastColumn; column++) {
+                mGridCells[size_t(row) * mGridColumns + column + 1]++;
+            }
+        }
+    }
+    for (size_t cell = 1; cell < mGridCells.size(); cell++) {
+        mGridCells[cell] += mGridCells[cell - 1];
+    }
+
+    mGridKeys.resize(mGridCells.back());
+    std::vector<quint32> next(mGridCells.begin(), mGridCells.end() - 1);
+    for (int i = 0; i < size(); i++) {
+        cellRange(i, firstColumn, lastColumn, firstRow, lastRow);
+        for (int row = firstRow; row < lastRow; row++) {
+            for (int column = firstColumn; column < lastColumn; column++) {
+                mGridKeys[next[size_t(row) * mGridColumns + column]++] = quint16(i);
+            }
+        }
+    }
+}
+
+int UnivKbd::KeyboardModel::keyAt(float x, float y) const {
+    if (x < 0 || y < 0) {
+        return -1;
+    }
+    int column = int(x * GridResolution);
+    int row = int(y * GridResolution);
+    if (column >= mGridColumns || row >= mGridRows) {
+        return -1;
+    }
+
+    size_t cell = size_t(row) * mGridColumns + column;
+    for (quint32 k = mGridCells[cell]; k < mGridCells[cell + 1]; k++) {
+        int i = mGridKeys[k];
+        if (x >= mX[i] && x < mX[i] + mXSpan[i] && y >= mY[i] && y < mY[i] + mYSpan[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
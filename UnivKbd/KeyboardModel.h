@@ -0,0 +1,301 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#ifndef UNIVKBD_KEYBOARDMODEL_H
+#define UNIVKBD_KEYBOARDMODEL_H
+
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Key.h"
+#include "Keyboard.h"
+
+namespace UnivKbd {
+
+    class KeyboardModel;
+
+    /**
+     * @class KeyHandle
+     *
+     * @brief A key of a KeyboardModel, referred to by its index.
+     *
+     * A handle is a shared pointer to the model and an index, so copying it, or passing it in a signal, allocates
+     * nothing. It offers the same accessors as Key, read from the arrays of the model.
+     *
+     * The handle shares the ownership of its model, so it stays valid after the keyboard switches to another layout,
+     * when it is delivered through a queued connection or kept by the application.
+     */
+    class KeyHandle {
+    public:
+        /**
+         * @brief Constructs a null handle, referring to no key.
+         */
+        KeyHandle() = default;
+
+        /**
+         * @brief Constructs a handle to a key of a model.
+         */
+        KeyHandle(std::shared_ptr<const KeyboardModel> model, int index) : mModel(std::move(model)), mIndex(index) {
+
+        }
+
+        inline bool isNull() const {
+            return mModel == nullptr;
+        }
+
+        inline const KeyboardModel *getModel() const {
+            return mModel.get();
+        }
+
+        inline int getIndex() const {
+            return mIndex;
+        }
+
+        inline KeyType getType() const;
+
+        /**
+         * @brief Get the characters associated to the key.
+         *
+         * @return The characters, viewing the labels of the model without copying them. They are only valid as long
+         * as the model is alive, so as long as a handle to it.
+         **/
+        inline QString getCharacters() const;
+
+        inline const QStringList &getSpecials(int i) const;
+
+        inline float getX() const;
+
+        inline float getY() const;
+
+        inline float getXSpan() const;
+
+        inline float getYSpan() const;
+
+        inline QString toString(int i = 0) const {
+            return Key::toString(getType(), getCharacters(), i);
+        }
+
+        /**
+         * @brief Returns the label of the key at a modifier level, precomputed by the model.
+         *
+         * @param level The modifier level, see Key::level().
+         */
+        inline const QString &getLabel(int level) const;
+
+        inline Qt::Key toQtKey() const {
+            return Key::toQtKey(getType(), getCharacters());
+        }
+
+        inline bool operator==(const KeyHandle &other) const {
+            return mModel == other.mModel && mIndex == other.mIndex;
+        }
+
+        inline bool operator!=(const KeyHandle &other) const {
+            return !(*this == other);
+        }
+
+    private:
+        std::shared_ptr<const KeyboardModel> mModel;
+        int mIndex = -1;
+    };
+
+    /**
+     * @class KeyboardModel
+     *
+     * @brief The keys of a keyboard, stored as a structure of arrays.
+     *
+     * The types, the geometry and the label offsets of the keys each live in a contiguous array, and the labels of
+     * all the keys in a single string. Layout, hit-testing and modifier refreshes walk the array they need only, and
+     * the keys are handed out as KeyHandle.
+     *
+     * A model is immutable once built. It must be owned by a std::shared_ptr, which the handles of its keys share.
+     */
+    class KeyboardModel : public std::enable_shared_from_this<KeyboardModel> {
+    public:
+        /**
+         * @brief Constructs a model without any key.
+         */
+        KeyboardModel() = default;
+
+        /**
+         * @brief Constructs the model of a keyboard.
+         */
+        explicit KeyboardModel(const Keyboard &keyboard);
+
+        /**
+         * @brief Returns the number of keys.
+         */
+        inline int size() const {
+            return (int)mTypes.size();
+        }
+
+        /**
+         * @brief Returns a handle to the key at an index.
+         */
+        inline KeyHandle key(int index) const {
+            return KeyHandle(shared_from_this(), index);
+        }
+
+        inline KeyType type(int index) const {
+            return mTypes[index];
+        }
+
+        inline float x(int index) const {
+            return mX[index];
+        }
+
+        inline float y(int index) const {
+            return mY[index];
+        }
+
+        inline float xSpan(int index) const {
+            return mXSpan[index];
+        }
+
+        inline float ySpan(int index) const {
+            return mYSpan[index];
+        }
+
+        /**
+         * @brief Returns the characters of a key, viewing the labels of the model.
+         */
+        inline QString characters(int index) const {
+            return QString::fromRawData(mLabels.constData() + mLabelOffsets[index], int(mLabelOffsets[index + 1] - mLabelOffsets[index]));
+        }
+
+        /**
+         * @brief Returns the label of a key at a modifier level.
+         *
+         * The labels of all the keys at all the levels are built once with the model, so changing the modifiers
+         * only changes the level the labels are read at.
+         *
+         * @param index The index of the key.
+         * @param level The modifier level, between 0 and Key::MaxLevels - 1.
+         */
+        inline const QString &label(int index, int level) const {
+            return mLevelLabels[size_t(index) * Key::MaxLevels + level];
+        }
+
+        /**
+         * @brief Returns the special characters of a character of a key.
+         */
+        inline const QStringList &specials(int index, int i) const {
+            if (mSpecialsTable == nullptr || i < 0 || i >= Key::MaxSpecials) {
+                return SpecialsTable::emptySpecials();
+            }
+            return mSpecialsTable->specials(mSpecials[index][i]);
+        }
+
+        /**
+         * @brief Returns the width of the keyboard, in keys.
+         */
+        inline float width() const {
+            return mWidth;
+        }
+
+        /**
+         * @brief Returns the height of the keyboard, in keys.
+         */
+        inline float height() const {
+            return mHeight;
+        }
+
+        /**
+         * @brief Returns the key at a position.
+         *
+         * The position is looked up in a grid of quarter key cells built with the model, each listing the keys
+         * overlapping it, so only a key or two are tested whatever the size of the keyboard.
+         *
+         * @param x The x position, in keys.
+         * @param y The y position, in keys.
+         * @return The index of the key, or -1 if there is no key at this position.
+         */
+        int keyAt(float x, float y) const;
+
+        /**
+         * @brief The number of cells of the hit-test grid per key.
+         */
+        static constexpr int GridResolution = 4;
+
+    private:
+        void buildGrid();
+
+        void cellRange(int index, int &firstColumn, int &lastColumn, int &firstRow, int &lastRow) const;
+
+    private:
+        std::vector<KeyType> mTypes;
+        std::vector<float> mX, mY, mXSpan, mYSpan;
+        std::vector<quint32> mLabelOffsets;  // one more than the keys, the labels of a key end where the next ones start
+        QString mLabels;
+        std::vector<QString> mLevelLabels;  // Key::MaxLevels per key, shared with the other keyboards by the StringPool
+        std::vector<std::array<quint16, Key::MaxSpecials>> mSpecials;
+        const SpecialsTable *mSpecialsTable = nullptr;
+
+        float mWidth = 0, mHeight = 0;
+        int mGridColumns = 0, mGridRows = 0;
+        std::vector<quint32> mGridCells;  // one more than the cells, the keys of a cell end where the next ones start
+        std::vector<quint16> mGridKeys;
+    };
+
+    inline KeyType KeyHandle::getType() const {
+        return mModel->type(mIndex);
+    }
+
+    inline QString KeyHandle::getCharacters() const {
+        return mModel->characters(mIndex);
+    }
+
+    inline const QString &KeyHandle::getLabel(int level) const {
+        return mModel->label(mIndex, level);
+    }
+
+    inline const QStringList &KeyHandle::getSpecials(int i) const {
+        return mModel->specials(mIndex, i);
+    }
+
+    inline float KeyHandle::getX() const {
+        return mModel->x(mIndex);
+    }
+
+    inline float KeyHandle::getY() const {
+        return mModel->y(mIndex);
+    }
+
+    inline float KeyHandle::getXSpan() const {
+        return mModel->xSpan(mIndex);
+    }
+
+    inline float KeyHandle::getYSpan() const {
+        return mModel->ySpan(mIndex);
+    }
+
+}
+
+Q_DECLARE_METATYPE(UnivKbd::KeyHandle)
+
+#endif // UNIVKBD_KEYBOARDMODEL_H
@@ -0,0 +1,89 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "KeycapCache.h"
+
+#include <QPainter>
+#include <QPixmapCache>
+
+QPixmap UnivKbd::KeycapCache::keycap(const QString &label, const QPixmap &icon, const QSize &size, KeycapState state,
+                                     const QFont &labelFont, qreal devicePixelRatio) {
+    if (size.isEmpty()) {
+        return QPixmap();
+    }
+
+    QString cacheKey = QString("univkbd_keycap_%1_%2x%3_%4_").arg((int)state).arg(size.width()).arg(size.height()).arg(devicePixelRatio);
+    if (icon.isNull()) {
+        cacheKey += "text_" + labelFont.key() + "_" + label;
+    } else {
+        // the icons are shared by the IconCache, so the same icon always has the same cache key
+        cacheKey += QString("icon_%1").arg(icon.cacheKey());
+    }
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(cacheKey, &pixmap)) {
+        pixmap = render(label, icon, size, state, labelFont, devicePixelRatio);
+        QPixmapCache::insert(cacheKey, pixmap);
+    }
+    return pixmap;
+}
+
+QPixmap UnivKbd::KeycapCache::render(const QString &label, const QPixmap &icon, const QSize &size, KeycapState state,
+                                     const QFont &labelFont, qreal devicePixelRatio) {
+    QPixmap pixmap(size * devicePixelRatio);
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+
+    // Draw the background according to the button's state (hover, pressed, checked, etc.)
+    switch (state) {
+        case KeycapState::Down:
+        case KeycapState::Hovered:
+            pixmap.fill(QColor(0xCC, 0xCC, 0xCC));
+            break;
+
+        case KeycapState::Checked:
+            pixmap.fill(QColor(0xFF, 0xCC, 0x99));
+            break;
+
+        default:
+            pixmap.fill(QColor(0xFF, 0xFF, 0xFF));
+            break;
+    }
+
+    QPainter painter(&pixmap);
+    QRect rect(QPoint(0, 0), size);
+
+    if (icon.isNull()) {
+        painter.setFont(labelFont);
+        painter.setPen(Qt::black);
+        painter.drawText(rect, Qt::AlignCenter, label);
+    } else {
+        // the icon is already rendered at its size, it is only centered
+        qreal svgWidth = icon.width() / icon.devicePixelRatio();
+        qreal svgHeight = icon.height() / icon.devicePixelRatio();
+
+        QRectF svgRect(rect.center().x() - svgWidth / 2, rect.center().y() - svgHeight / 2, svgWidth, svgHeight);
+        painter.drawPixmap(svgRect, icon, QRectF(icon.rect()));
+    }
+
+    return pixmap;
+}
@@ -0,0 +1,80 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#ifndef UNIVKBD_KEYCAPCACHE_H
+#define UNIVKBD_KEYCAPCACHE_H
+
+#include <QFont>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+
+#include "Key.h"
+
+namespace UnivKbd {
+
+    /**
+     * @brief The visual state of a key.
+     */
+    enum class KeycapState {
+        Normal = 0,
+        Hovered = 1,
+        Down = 2,
+        Checked = 3
+    };
+
+    /**
+     * @class KeycapCache
+     *
+     * @brief Renders the keys once, and keeps the rendered keys in the QPixmapCache.
+     *
+     * A key is rendered to a pixmap the first time it is painted with a given label or icon, size, state, font and
+     * device pixel ratio. Repainting it afterwards, when it is hovered, pressed or checked again, is a single blit
+     * instead of filling its background and rendering its label. The cache is shared by the buttons and by
+     * VirtualKeyboardView, and its size is bounded by QPixmapCache::cacheLimit().
+     */
+    class KeycapCache {
+    public:
+        /**
+         * @brief Returns a rendered key.
+         *
+         * @param label The text of the key, drawn when it has no icon.
+         * @param icon The icon of the key, rendered at its final size by the IconCache, or a null pixmap to draw
+         * its label.
+         * @param size The size of the key, in device independent pixels.
+         * @param state The visual state of the key.
+         * @param labelFont The font of the label.
+         * @param devicePixelRatio The device pixel ratio of the device the key is painted on.
+         * @return The rendered key.
+         */
+        static QPixmap keycap(const QString &label, const QPixmap &icon, const QSize &size, KeycapState state,
+                              const QFont &labelFont, qreal devicePixelRatio);
+
+    private:
+        static QPixmap render(const QString &label, const QPixmap &icon, const QSize &size, KeycapState state,
+                              const QFont &labelFont, qreal devicePixelRatio);
+    };
+
+}
+
+#endif // UNIVKBD_KEYCAPCACHE_H
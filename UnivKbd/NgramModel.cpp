@@ -0,0 +1,452 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+#include "NgramModel.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+
+static_assert(sizeof(UnivKbd::NgramHeader) == 16, "NgramHeader must match the binary format");
+static_assert(sizeof(UnivKbd::NgramEntry) == 8, "NgramEntry must match the binary format");
+
+namespace {
+
+    const quint32 MaxWordCount = 1u << 24;
+
+    // 8 steps per doubling: the 8 bits cover every 32-bit count, with a precision of 9%
+    quint32 quantize(quint32 count) {
+        if (count <= 1) {
+            return 0;
+        }
+        return (quint32)std::min(255.0, std::round(8.0 * std::log2((double)count)));
+    }
+
+    quint32 dequantize(quint32 quantizedCount) {
+        return (quint32)std::round(std::exp2(quantizedCount / 8.0));
+    }
+
+    // the image of a model is its binary file in host byte order, aligned for the entries and offsets
+    using Image = std::vector<quint32>;
+
+    // checks once that every entry predicts a word of the vocabulary, and that the words lie one after the other in
+    // the characters, so that the queries can read them without any bounds check
+    bool validImage(const UnivKbd::NgramEntry *entries, quint32 entryCount, const quint32 *offsets, quint32 wordCount) {
+        for (quint32 i = 0; i < entryCount; i++) {
+            if ((entries[i].wordAndCount & (MaxWordCount - 1)) >= wordCount) {
+                return false;
+            }
+        }
+        for (quint32 i = 0; i < wordCount; i++) {
+            if (offsets[i] > offsets[i + 1]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    // converts an image between the host and the file byte order, in both directions
+    void swapImage(Image &image, quint32 entryCount, quint32 wordCount) {
+        // every field up to the characters is a 32-bit integer, except the magic
+        std::size_t characters = 4 + 2 * (std::size_t)entryCount + (std::size_t)wordCount + 1;
+        for (std::size_t i = 1; i < characters && i < image.size(); i++) {
+            image[i] = qbswap(image[i]);
+        }
+        // the characters are 16-bit integers, and the padding at the end is swapped along with them
+        for (std::size_t i = characters; i < image.size(); i++) {
+            image[i] = ((image[i] & 0x00ff00ffu) << 8) | ((image[i] >> 8) & 0x00ff00ffu);
+        }
+    }
+#endif
+
+}
+
+UnivKbd::NgramModel::NgramModel(const std::vector<std::pair<QStringList, quint32>> &ngrams) {
+    std::vector<Ngram> contextNgrams;
+    contextNgrams.reserve(ngrams.size());
+    for (const auto &ngram : ngrams) {
+        const QStringList &words = ngram.first;
+        if (words.size() < 2 || words.last().isEmpty()) {
+            continue;
+        }
+        QStringList context = words.mid(0, words.size() - 1);
+        contextNgrams.push_back({contextHash(context, std::min<int>(words.size(), 3)), words.last(), ngram.second});
+    }
+    *this = build(std::move(contextNgrams));
+}
+
+quint32 UnivKbd::NgramModel::contextHash(const QStringList &context, int order) {
+    if (context.size() < order - 1) {
+        return 0;
+    }
+
+    // FNV-1a over the lowercase words, separated by a null character
+    quint32 hash = 2166136261u;
+    for (int i = context.size() - (order - 1); i < context.size(); i++) {
+        QString word = context[i].toLower();
+        for (QChar character : word) {
+            hash = (hash ^ character.unicode()) * 16777619u;
+        }
+        hash = (hash ^ 0u) * 16777619u;
+    }
+
+    // 0 means no context
+    return hash != 0 ? hash : 1;
+}
+
+UnivKbd::NgramModel UnivKbd::NgramModel::build(std::vector<Ngram> ngrams) {
+    // merge the duplicated n-grams
+    std::sort(ngrams.begin(), ngrams.end(), [](const Ngram &a, const Ngram &b) {
+        return a.context != b.context ? a.context < b.context : a.word < b.word;
+    });
+    std::vector<Ngram> merged;
+    for (auto &ngram : ngrams) {
+        if (!merged.empty() && merged.back().context == ngram.context && merged.back().word == ngram.word) {
+            merged.back().count = (quint32)std::min<quint64>((quint64)merged.back().count + ngram.count, std::numeric_limits<quint32>::max());
+        } else {
+            merged.push_back(std::move(ngram));
+        }
+    }
+
+    QStringList vocabulary;
+    for (const auto &ngram : merged) {
+        vocabulary << ngram.word;
+    }
+    std::sort(vocabulary.begin(), vocabulary.end());
+    vocabulary.erase(std::unique(vocabulary.begin(), vocabulary.end()), vocabulary.end());
+    if ((quint32)vocabulary.size() > MaxWordCount) {
+        qDebug() << "Too many words in the n-gram model, keeping the first" << MaxWordCount;
+        vocabulary.erase(vocabulary.begin() + MaxWordCount, vocabulary.end());
+    }
+
+    std::vector<NgramEntry> entries;
+    entries.reserve(merged.size());
+    for (const auto &ngram : merged) {
+        auto it = std::lower_bound(vocabulary.begin(), vocabulary.end(), ngram.word);
+        if (it == vocabulary.end() || *it != ngram.word) {
+            continue;
+        }
+        entries.push_back({ngram.context, (quantize(ngram.count) << 24) | (quint32)(it - vocabulary.begin())});
+    }
+
+    // sorted by context, then from the most to the least frequent word
+    std::sort(entries.begin(), entries.end(), [](const NgramEntry &a, const NgramEntry &b) {
+        if (a.context != b.context) {
+            return a.context < b.context;
+        }
+        if ((a.wordAndCount >> 24) != (b.wordAndCount >> 24)) {
+            return (a.wordAndCount >> 24) > (b.wordAndCount >> 24);
+        }
+        return a.wordAndCount < b.wordAndCount;
+    });
+
+    quint32 characterCount = 0;
+    for (const auto &word : vocabulary) {
+        characterCount += (quint32)word.size();
+    }
+
+    std::size_t headerSize = sizeof(NgramHeader) / sizeof(quint32);
+    std::size_t entriesSize = entries.size() * sizeof(NgramEntry) / sizeof(quint32);
+    std::size_t offsetsSize = (std::size_t)vocabulary.size() + 1;
+    auto image = std::make_shared<Image>(headerSize + entriesSize + offsetsSize + (characterCount + 1) / 2, 0);
+
+    NgramHeader *header = reinterpret_cast<NgramHeader*>(image->data());
+    std::memcpy(header->magic, "UKNG", 4);
+    header->version = 1;
+    header->entryCount = (quint32)entries.size();
+    header->wordCount = (quint32)vocabulary.size();
+
+    NgramModel model;
+    model.mEntryCount = header->entryCount;
+    model.mWordCount = header->wordCount;
+
+    NgramEntry *modelEntries = reinterpret_cast<NgramEntry*>(image->data() + headerSize);
+    std::copy(entries.begin(), entries.end(), modelEntries);
+    quint32 *offsets = image->data() + headerSize + entriesSize;
+    quint16 *characters = reinterpret_cast<quint16*>(offsets + offsetsSize);
+    quint32 offset = 0;
+    for (int i = 0; i < vocabulary.size(); i++) {
+        offsets[i] = offset;
+        std::memcpy(characters + offset, vocabulary[i].constData(), vocabulary[i].size() * sizeof(quint16));
+        offset += (quint32)vocabulary[i].size();
+    }
+    offsets[vocabulary.size()] = offset;
+
+    model.mEntries = modelEntries;
+    model.mOffsets = offsets;
+    model.mCharacters = characters;
+    model.mStorage = image;
+    return model;
+}
+
+UnivKbd::NgramModel UnivKbd::NgramModel::fromTextFile(const QString &path, bool *ok) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (ok != nullptr) {
+            *ok = false;
+        }
+        return NgramModel();
+    }
+    if (ok != nullptr) {
+        *ok = true;
+    }
+
+    std::vector<std::pair<QStringList, quint32>> ngrams;
+
+    QTextStream in(&file);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    in.setCodec("UTF-8");
+#endif
+    while (!in.atEnd()) {
+        QStringList parts = in.readLine().simplified().split(QLatin1Char(' '));
+        if (parts.size() < 3) {
+            continue;
+        }
+
+        bool hasCount = false;
+        qulonglong count = parts.last().toULongLong(&hasCount);
+        if (!hasCount) {
+            continue;
+        }
+        parts.removeLast();
+        ngrams.emplace_back(parts, (quint32)std::min<qulonglong>(count, std::numeric_limits<quint32>::max()));
+    }
+
+    return NgramModel(ngrams);
+}
+
+UnivKbd::NgramModel UnivKbd::NgramModel::fromBinaryFile(const QString &path, bool *ok) {
+    if (ok != nullptr) {
+        *ok = false;
+    }
+
+    auto file = std::make_shared<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        return NgramModel();
+    }
+
+    NgramHeader header;
+    if (file->read((char*)&header, sizeof(header)) != (qint64)sizeof(header)) {
+        return NgramModel();
+    }
+    if (std::memcmp(header.magic, "UKNG", 4) != 0 || qFromLittleEndian(header.version) != 1) {
+        qDebug() << "Not a valid n-gram model file" << path;
+        return NgramModel();
+    }
+
+    quint32 entryCount = qFromLittleEndian(header.entryCount);
+    quint32 wordCount = qFromLittleEndian(header.wordCount);
+    qint64 offsetsEnd = (qint64)sizeof(header) + (qint64)entryCount * (qint64)sizeof(NgramEntry) + ((qint64)wordCount + 1) * 4;
+    if (file->size() < offsetsEnd) {
+        qDebug() << "Truncated n-gram model file" << path;
+        return NgramModel();
+    }
+    qint64 size = file->size();
+
+    NgramModel model;
+    model.mEntryCount = entryCount;
+    model.mWordCount = wordCount;
+
+    const uchar *data = file->map(0, size);
+    const uchar *image = data;
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    if (data == nullptr || (quintptr)data % alignof(quint32) != 0) {
+#endif
+        // compressed resources cannot be mapped, and misaligned or big-endian data cannot be used in place
+        auto copy = std::make_shared<Image>((size + 3) / 4, 0);
+        if (data != nullptr) {
+            std::memcpy(copy->data(), data, size);
+        } else if (!file->seek(0) || file->read((char*)copy->data(), size) != size) {
+            return NgramModel();
+        }
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+        swapImage(*copy, entryCount, wordCount);
+#endif
+        image = reinterpret_cast<const uchar*>(copy->data());
+        model.mStorage = copy;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    } else {
+        // the mapping lives as long as the file is open, so the model keeps the file
+        model.mStorage = file;
+    }
+#endif
+
+    model.mEntries = reinterpret_cast<const NgramEntry*>(image + sizeof(header));
+    model.mOffsets = reinterpret_cast<const quint32*>(image + sizeof(header) + (qint64)entryCount * (qint64)sizeof(NgramEntry));
+    model.mCharacters = reinterpret_cast<const quint16*>(image + offsetsEnd);
+    if (offsetsEnd + (qint64)model.mOffsets[wordCount] * 2 > size) {
+        qDebug() << "Truncated n-gram model file" << path;
+        return NgramModel();
+    }
+    if (!validImage(model.mEntries, entryCount, model.mOffsets, wordCount)) {
+        qDebug() << "Corrupted n-gram model file" << path;
+        return NgramModel();
+    }
+
+    if (ok != nullptr) {
+        *ok = true;
+    }
+    return model;
+}
+
+UnivKbd::NgramModel UnivKbd::NgramModel::fromFile(const QString &path, bool *ok) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (ok != nullptr) {
+            *ok = false;
+        }
+        return NgramModel();
+    }
+
+    if (file.peek(4) == "UKNG") {
+        return fromBinaryFile(path, ok);
+    }
+    return fromTextFile(path, ok);
+}
+
+std::vector<UnivKbd::NgramModel::Ngram> UnivKbd::NgramModel::ngrams() const {
+    std::vector<Ngram> ngrams;
+    ngrams.reserve(mEntryCount);
+    for (quint32 i = 0; i < mEntryCount; i++) {
+        ngrams.push_back({mEntries[i].context, word(mEntries[i].wordAndCount & (MaxWordCount - 1)), dequantize(mEntries[i].wordAndCount >> 24)});
+    }
+    for (auto context = mLearned.begin(); context != mLearned.end(); ++context) {
+        for (auto learned = context.value().begin(); learned != context.value().end(); ++learned) {
+            ngrams.push_back({context.key(), learned.key(), (quint32)std::min<quint64>((quint64)learned.value() * LearnedWeight, std::numeric_limits<quint32>::max())});
+        }
+    }
+    return ngrams;
+}
+
+bool UnivKbd::NgramModel::saveBinaryFile(const QString &path) const {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    NgramModel model = build(ngrams());
+    auto image = std::static_pointer_cast<const Image>(model.mStorage);
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    qint64 size = (qint64)(image->size() * sizeof(quint32));
+    return file.write((const char*)image->data(), size) == size;
+#else
+    Image swapped = *image;
+    swapImage(swapped, model.mEntryCount, model.mWordCount);
+    qint64 size = (qint64)(swapped.size() * sizeof(quint32));
+    return file.write((const char*)swapped.data(), size) == size;
+#endif
+}
+
+QString UnivKbd::NgramModel::word(quint32 index) const {
+    return QString((const QChar*)(mCharacters + mOffsets[index]), (int)(mOffsets[index + 1] - mOffsets[index]));
+}
+
+void UnivKbd::NgramModel::learn(const QStringList &context, const QString &word) {
+    if (word.isEmpty()) {
+        return;
+    }
+    for (int order = 2; order <= 3; order++) {
+        quint32 hash = contextHash(context, order);
+        if (hash != 0) {
+            mLearned[hash][word]++;
+        }
+    }
+}
+
+void UnivKbd::NgramModel::collect(quint32 context, int maxResults, std::vector<std::pair<QString, quint32>> &candidates) const {
+    auto range = std::equal_range(mEntries, mEntries + mEntryCount, NgramEntry{context, 0}, [](const NgramEntry &a, const NgramEntry &b) {
+        return a.context < b.context;
+    });
+
+    // the entries of a context are sorted from the most to the least frequent word
+    for (auto entry = range.first; entry != range.second && entry - range.first < maxResults; ++entry) {
+        candidates.emplace_back(word(entry->wordAndCount & (MaxWordCount - 1)), dequantize(entry->wordAndCount >> 24));
+    }
+
+    auto learned = mLearned.find(context);
+    if (learned == mLearned.end()) {
+        return;
+    }
+    for (auto it = learned.value().begin(); it != learned.value().end(); ++it) {
+        auto candidate = std::find_if(candidates.begin(), candidates.end(), [&](const std::pair<QString, quint32> &value) {
+            return value.first == it.key();
+        });
+
+        quint32 count = it.value() * LearnedWeight;
+        if (candidate != candidates.end()) {
+            candidate->second += count;
+            continue;
+        }
+
+        // a learned word may be in the model, below the most frequent ones
+        for (auto entry = range.first + std::min<qint64>(maxResults, range.second - range.first); entry != range.second; ++entry) {
+            quint32 index = entry->wordAndCount & (MaxWordCount - 1);
+            quint32 length = mOffsets[index + 1] - mOffsets[index];
+            if ((int)length == it.key().size() && std::memcmp(mCharacters + mOffsets[index], it.key().constData(), length * sizeof(quint16)) == 0) {
+                count += dequantize(entry->wordAndCount >> 24);
+                break;
+            }
+        }
+        candidates.emplace_back(it.key(), count);
+    }
+}
+
+QStringList UnivKbd::NgramModel::predict(const QStringList &context, int maxResults) const {
+    QStringList results;
+
+    // back off from the trigrams to the bigrams
+    for (int order = 3; order >= 2 && results.size() < maxResults; order--) {
+        quint32 hash = contextHash(context, order);
+        if (hash == 0) {
+            continue;
+        }
+
+        std::vector<std::pair<QString, quint32>> candidates;
+        collect(hash, maxResults, candidates);
+        std::stable_sort(candidates.begin(), candidates.end(), [](const std::pair<QString, quint32> &a, const std::pair<QString, quint32> &b) {
+            return a.second > b.second;
+        });
+
+        for (const auto &candidate : candidates) {
+            if (results.size() >= maxResults) {
+                break;
+            }
+            if (!results.contains(candidate.first)) {
+                results << candidate.first;
+            }
+        }
+    }
+
+    return results;
+}
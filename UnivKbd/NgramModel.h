@@ -0,0 +1,208 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+#ifndef UNIVKBD_NGRAMMODEL_H
+#define UNIVKBD_NGRAMMODEL_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace UnivKbd {
+
+    /**
+     * @brief An n-gram of a binary n-gram model file.
+     *
+     * The context is a hash of the one or two words preceding the predicted word. The predicted word and the
+     * quantized count share a single integer, so that an n-gram only takes 8 bytes.
+     */
+    struct NgramEntry {
+        quint32 context;       ///< Hash of the preceding words, see NgramModel::contextHash.
+        quint32 wordAndCount;  ///< Index of the predicted word in the vocabulary in the 24 low bits, quantized count in the 8 high bits.
+    };
+
+    /**
+     * @brief The header of a binary n-gram model file.
+     *
+     * A binary n-gram model file is made of this header, followed by the n-grams sorted by context and decreasing
+     * count, then by the wordCount + 1 offsets of the words in the character array, and finally by the UTF-16
+     * characters of the words, in little-endian byte order. It can be used in place, without any parsing.
+     *
+     * @see NgramModel::saveBinaryFile
+     */
+    struct NgramHeader {
+        char magic[4];       ///< Always "UKNG".
+        quint32 version;     ///< The version of the format, currently 1.
+        quint32 entryCount;  ///< The number of n-grams.
+        quint32 wordCount;   ///< The number of words in the vocabulary.
+    };
+
+    /**
+     * @class NgramModel
+     *
+     * @brief A bigram and trigram model predicting the next word from the words typed before it.
+     *
+     * The n-grams are stored in a sorted array, and the predictions for a context are found with a binary search,
+     * so predicting does not depend on the size of the model. Counts are quantized on a logarithmic scale, which
+     * keeps their order while fitting them in 8 bits.
+     *
+     * The words committed by the user are learned in a small table on top of the model, and are folded into it by
+     * saveBinaryFile(). Models loaded from a binary file are mapped in memory and queried in place.
+     */
+    class NgramModel {
+    public:
+        /**
+         * @brief The number of occurrences in the corpus that a word committed by the user counts for.
+         */
+        static constexpr quint32 LearnedWeight = 16;
+
+        /**
+         * @brief Constructs an empty model.
+         */
+        NgramModel() = default;
+
+        /**
+         * @brief Constructs a model from a list of n-grams and their counts.
+         *
+         * @param ngrams The n-grams with their counts. The last word of an n-gram is the predicted one, and the one
+         * or two words before it are its context. N-grams of a single word are ignored, and only the last two words
+         * of the context of longer ones are used.
+         */
+        explicit NgramModel(const std::vector<std::pair<QStringList, quint32>> &ngrams);
+
+        /**
+         * @brief Loads a model from a text file.
+         *
+         * The file contains one n-gram per line, made of its words followed by its count, separated by spaces or
+         * tabs:
+         * ```
+         * of the	1532854
+         * one of the	83217
+         * ```
+         *
+         * @param path The path of the file.
+         * @param ok If not null, set to false when the file could not be opened.
+         * @return The loaded model.
+         */
+        static NgramModel fromTextFile(const QString &path, bool *ok = nullptr);
+
+        /**
+         * @brief Loads a model from a binary file.
+         *
+         * The file is mapped in memory and used in place. Files that cannot be mapped, like compressed resources,
+         * are read in memory instead.
+         *
+         * @param path The path of the file.
+         * @param ok If not null, set to false when the file could not be opened or is not a valid model.
+         * @return The loaded model.
+         * @see saveBinaryFile
+         */
+        static NgramModel fromBinaryFile(const QString &path, bool *ok = nullptr);
+
+        /**
+         * @brief Loads a model from a binary or a text file, depending on its content.
+         *
+         * @param path The path of the file.
+         * @param ok If not null, set to false when the file could not be loaded.
+         * @return The loaded model.
+         */
+        static NgramModel fromFile(const QString &path, bool *ok = nullptr);
+
+        /**
+         * @brief Saves the model, including the learned words, to a binary file.
+         *
+         * @param path The path of the file.
+         * @return True on success.
+         * @see fromBinaryFile
+         */
+        bool saveBinaryFile(const QString &path) const;
+
+        /**
+         * @brief Returns true if the model cannot predict anything.
+         */
+        inline bool isEmpty() const {
+            return mEntryCount == 0 && mLearned.isEmpty();
+        }
+
+        /**
+         * @brief Learns a word committed by the user.
+         *
+         * @param context The words typed before, the last one being the closest to the committed word.
+         * @param word The committed word.
+         */
+        void learn(const QStringList &context, const QString &word);
+
+        /**
+         * @brief Returns the words most likely to follow the given context.
+         *
+         * The words following the last two words of the context come first, then the words following the last one.
+         *
+         * @param context The words typed before, the last one being the closest to the predicted word.
+         * @param maxResults The maximum number of words to return.
+         * @return At most maxResults words, from the most to the least likely.
+         */
+        QStringList predict(const QStringList &context, int maxResults) const;
+
+        /**
+         * @brief Returns the hash of the last order - 1 words of a context.
+         *
+         * @param context The words typed before the predicted word.
+         * @param order 2 for a bigram context, 3 for a trigram context.
+         * @return The hash, or 0 if the context has less than order - 1 words.
+         */
+        static quint32 contextHash(const QStringList &context, int order);
+
+    private:
+        struct Ngram {
+            quint32 context;
+            QString word;
+            quint32 count;
+        };
+
+        static NgramModel build(std::vector<Ngram> ngrams);
+
+        std::vector<Ngram> ngrams() const;
+
+        QString word(quint32 index) const;
+
+        void collect(quint32 context, int maxResults, std::vector<std::pair<QString, quint32>> &candidates) const;
+
+    private:
+        std::shared_ptr<const void> mStorage;
+        const NgramEntry *mEntries = nullptr;
+        const quint32 *mOffsets = nullptr;
+        const quint16 *mCharacters = nullptr;
+        quint32 mEntryCount = 0;
+        quint32 mWordCount = 0;
+
+        QHash<quint32, QHash<QString, quint32>> mLearned;
+    };
+
+}
+
+#endif // UNIVKBD_NGRAMMODEL_H
@@ -0,0 +1,103 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "SpecialsTable.h"
+#include "StringPool.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <memory>
+
+UnivKbd::SpecialsTable::SpecialsTable(const std::map<QChar, QStringList> &specials) {
+    // the entries are indexed from 1, 0 is NoSpecials, and the indices must fit in the keys
+    for (const auto &special : specials) {
+        if (mEntries.size() >= 0xFFFF) {
+            qDebug() << "Too many special characters, ignoring" << special.first;
+            break;
+        }
+        // identical strings share their data, with the labels of the keys too
+        mEntries.push_back({special.first.unicode(), StringPool::instance().intern(special.second)});
+    }
+}
+
+const UnivKbd::SpecialsTable *UnivKbd::SpecialsTable::fromFile(const QString &path) {
+    static QMutex mutex;
+    static QHash<QString, std::shared_ptr<const SpecialsTable>> tables;
+
+    QMutexLocker locker(&mutex);
+    std::shared_ptr<const SpecialsTable> &table = tables[path];
+    if (table != nullptr) {
+        return table.get();
+    }
+
+    std::map<QChar, QStringList> specials;
+    QFile file(path);
+    file.open(QIODevice::ReadOnly);
+    if (!file.isOpen()) {
+        qDebug() << "Could not open specials file";
+    }
+    while (file.isOpen() && !file.atEnd()) {
+        QString line = file.readLine();
+        QStringList parts = line.split(":");
+        if (parts.size() != 2) {
+            continue;
+        }
+        QString key = parts[0].trimmed();
+        QStringList values = parts[1].split(",");
+        for (int i = 0; i < values.size(); i++) {
+            values[i] = values[i].trimmed();
+        }
+        specials[key.at(0)] = values;
+    }
+
+    table = std::make_shared<const SpecialsTable>(specials);
+    return table.get();
+}
+
+quint16 UnivKbd::SpecialsTable::find(QChar character) const {
+    char16_t unit = character.unicode();
+    auto it = std::lower_bound(mEntries.begin(), mEntries.end(), unit, [](const Entry &entry, char16_t value) {
+        return entry.character < value;
+    });
+    if (it == mEntries.end() || it->character != unit) {
+        return NoSpecials;
+    }
+    return quint16(it - mEntries.begin() + 1);
+}
+
+const QStringList &UnivKbd::SpecialsTable::specials(quint16 index) const {
+    if (index == NoSpecials || index > mEntries.size()) {
+        return emptySpecials();
+    }
+    return mEntries[index - 1].values;
+}
+
+const QStringList &UnivKbd::SpecialsTable::emptySpecials() {
+    static const QStringList empty;
+    return empty;
+}
@@ -0,0 +1,105 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#ifndef UNIVKBD_SPECIALSTABLE_H
+#define UNIVKBD_SPECIALSTABLE_H
+
+#include <QChar>
+#include <QString>
+#include <QStringList>
+
+#include <map>
+#include <vector>
+
+namespace UnivKbd {
+
+    /**
+     * @class SpecialsTable
+     *
+     * @brief The special characters offered for each character, like "à, â, ä" for "a".
+     *
+     * The table is immutable: the characters are sorted in a single array, each with its ready-made list of special
+     * characters, whose strings are interned in the StringPool. Keys refer to an entry by its index, so that applying
+     * the table to a keyboard does not copy any list, and the lists are returned by reference.
+     *
+     * Tables are never released, so the keys can refer to them by pointer.
+     */
+    class SpecialsTable {
+    public:
+        /**
+         * @brief The index meaning that a character has no special characters.
+         */
+        static constexpr quint16 NoSpecials = 0;
+
+        /**
+         * @brief Constructs a table from the special characters of each character.
+         */
+        explicit SpecialsTable(const std::map<QChar, QStringList> &specials);
+
+        /**
+         * @brief Returns the table parsed from a specials file.
+         *
+         * Each file is parsed once and its table is shared afterwards. The file contains a character and its special
+         * characters per line:
+         * ```
+         * a : à, â, ä, æ, ã, å, ā, ą, α (alpha)
+         * b : ß, β (bêta)
+         * ```
+         * This method is thread-safe.
+         *
+         * @param path The path of the file.
+         * @return The table, empty if the file could not be opened.
+         */
+        static const SpecialsTable *fromFile(const QString &path);
+
+        /**
+         * @brief Returns the index of the special characters of a character.
+         *
+         * @return The index, or NoSpecials if the character has none.
+         */
+        quint16 find(QChar character) const;
+
+        /**
+         * @brief Returns the special characters at an index returned by find().
+         *
+         * @return The special characters, or emptySpecials() for NoSpecials. The list lives as long as the table.
+         */
+        const QStringList &specials(quint16 index) const;
+
+        /**
+         * @brief Returns the empty list of the characters without special characters.
+         */
+        static const QStringList &emptySpecials();
+
+    private:
+        struct Entry {
+            char16_t character;
+            QStringList values;
+        };
+
+        std::vector<Entry> mEntries;   // sorted by character
+    };
+
+}
+
+#endif // UNIVKBD_SPECIALSTABLE_H
@@ -0,0 +1,76 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "StringPool.h"
+
+#include <QMutexLocker>
+
+UnivKbd::StringPool &UnivKbd::StringPool::instance() {
+    static StringPool pool;
+    return pool;
+}
+
+QString UnivKbd::StringPool::intern(const QString &string) {
+    QMutexLocker locker(&mMutex);
+    return internLocked(string);
+}
+
+QStringList UnivKbd::StringPool::intern(const QStringList &strings) {
+    QStringList interned;
+    interned.reserve(strings.size());
+
+    QMutexLocker locker(&mMutex);
+    for (const auto &string : strings) {
+        interned << internLocked(string);
+    }
+    return interned;
+}
+
+int UnivKbd::StringPool::size() const {
+    QMutexLocker locker(&mMutex);
+    return mStrings.size();
+}
+
+qint64 UnivKbd::StringPool::memoryUsage() const {
+    QMutexLocker locker(&mMutex);
+    return mMemoryUsage;
+}
+
+QString UnivKbd::StringPool::internLocked(const QString &string) {
+    // the empty labels of the special keys are all the same null string
+    if (string.isEmpty()) {
+        return QString();
+    }
+
+    auto it = mStrings.find(string);
+    if (it != mStrings.end()) {
+        return *it;
+    }
+
+    mStrings.insert(string);
+    // a view of static or mapped storage, made with QString::fromRawData(), has no capacity and costs the pool nothing
+    if (string.capacity() > 0) {
+        mMemoryUsage += qint64(string.size()) * qint64(sizeof(QChar));
+    }
+    return string;
+}
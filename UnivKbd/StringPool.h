@@ -0,0 +1,90 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#ifndef UNIVKBD_STRINGPOOL_H
+#define UNIVKBD_STRINGPOOL_H
+
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+namespace UnivKbd {
+
+    /**
+     * @class StringPool
+     *
+     * @brief Keeps a single copy of each distinct label of the keyboards.
+     *
+     * Most layouts share their digits, punctuation and Latin letters. Interning a string returns the copy already in
+     * the pool if there is one, so that all the keyboards imported during the life of the process share it instead of
+     * holding their own. Strings viewing static storage, like the compiled layouts, are pooled as views.
+     *
+     * The pool is never emptied: it only grows with the distinct strings, which are few. All the methods are
+     * thread-safe.
+     */
+    class StringPool {
+    public:
+        /**
+         * @brief Returns the pool shared by the whole process.
+         */
+        static StringPool &instance();
+
+        /**
+         * @brief Returns the pooled copy of a string, adding it to the pool if it is not there yet.
+         *
+         * A string viewing memory that may be released, like the labels of a KeyboardModel, must not be interned.
+         */
+        QString intern(const QString &string);
+
+        /**
+         * @brief Interns every string of a list.
+         */
+        QStringList intern(const QStringList &strings);
+
+        /**
+         * @brief Returns the number of distinct strings in the pool.
+         */
+        int size() const;
+
+        /**
+         * @brief Returns the memory used by the characters of the pooled strings, in bytes.
+         *
+         * Only the strings holding their own characters are counted, the views of static or mapped storage are not.
+         */
+        qint64 memoryUsage() const;
+
+    private:
+        StringPool() = default;
+
+        QString internLocked(const QString &string);
+
+    private:
+        mutable QMutex mMutex;
+        QSet<QString> mStrings;
+        qint64 mMemoryUsage = 0;
+    };
+
+}
+
+#endif // UNIVKBD_STRINGPOOL_H
@@ -0,0 +1,119 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+#include "SuggestionEngine.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+#include <utility>
+
+UnivKbd::SuggestionEngine::SuggestionEngine(QObject *parent) : QObject(parent) {
+
+}
+
+quint64 UnivKbd::SuggestionEngine::query(const QString &word, const QStringList &previousWords, const QStringList &specials, int maxResults, bool predictNextWord) {
+    quint64 generation = ++mGeneration;
+    QMetaObject::invokeMethod(this, [=]() {
+        run(generation, word, previousWords, specials, maxResults, predictNextWord);
+    }, Qt::QueuedConnection);
+    return generation;
+}
+
+void UnivKbd::SuggestionEngine::run(quint64 generation, const QString &word, const QStringList &previousWords, const QStringList &specials, int maxResults, bool predictNextWord) {
+    // the queries run in order, so the last one run is the one to run again when the dictionary changes
+    mLastQuery.valid = true;
+    mLastQuery.generation = generation;
+    mLastQuery.word = word;
+    mLastQuery.previousWords = previousWords;
+    mLastQuery.specials = specials;
+    mLastQuery.maxResults = maxResults;
+    mLastQuery.predictNextWord = predictNextWord;
+
+    // a more recent query is already waiting, its results would replace these ones anyway
+    if (generation != mGeneration.load()) {
+        return;
+    }
+
+    // move the cursor to the word through their common prefix, to keep the cached levels
+    const QString &prefix = mDictionaryCursor.prefix();
+    int common = 0;
+    while (common < prefix.size() && common < word.size() && prefix[common] == word[common]) {
+        common++;
+    }
+    while (mDictionaryCursor.prefix().size() > common) {
+        mDictionaryCursor.backspace();
+    }
+    for (int i = common; i < word.size(); i++) {
+        mDictionaryCursor.append(word[i]);
+    }
+
+    QStringList suggestions = specials;
+    if (!word.isEmpty()) {
+        suggestions << mDictionaryCursor.suggestions(maxResults - suggestions.size());
+    } else if (predictNextWord) {
+        QMutexLocker locker(&mNgramMutex);
+        suggestions << mNgramModel.predict(previousWords, maxResults - suggestions.size());
+    }
+
+    emit suggestionsReady(generation, suggestions);
+}
+
+void UnivKbd::SuggestionEngine::setDictionary(std::shared_ptr<const Dictionary> dictionary) {
+    QMetaObject::invokeMethod(this, [this, dictionary]() {
+        mDictionary = dictionary;
+        mDictionaryCursor = DictionaryCursor(mDictionary.get());
+
+        // the suggestions shown were computed with the previous dictionary, run the last query again unless a more
+        // recent one is already waiting, as it will use the new dictionary anyway
+        quint64 generation = mLastQuery.generation;
+        if (mLastQuery.valid && mGeneration.compare_exchange_strong(generation, generation + 1)) {
+            Query query = mLastQuery;
+            run(generation + 1, query.word, query.previousWords, query.specials, query.maxResults, query.predictNextWord);
+        }
+    }, Qt::QueuedConnection);
+}
+
+bool UnivKbd::SuggestionEngine::loadNgramModel(const QString &path) {
+    bool success = false;
+    NgramModel model = NgramModel::fromFile(path, &success);
+    if (!success) {
+        qDebug() << "Could not open n-gram model file" << path;
+        return false;
+    }
+
+    QMutexLocker locker(&mNgramMutex);
+    mNgramModel = std::move(model);
+    return true;
+}
+
+bool UnivKbd::SuggestionEngine::saveNgramModel(const QString &path) const {
+    QMutexLocker locker(&mNgramMutex);
+    return mNgramModel.saveBinaryFile(path);
+}
+
+void UnivKbd::SuggestionEngine::learn(const QStringList &previousWords, const QString &word) {
+    QMutexLocker locker(&mNgramMutex);
+    mNgramModel.learn(previousWords, word);
+}
@@ -0,0 +1,153 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+#ifndef UNIVKBD_SUGGESTIONENGINE_H
+#define UNIVKBD_SUGGESTIONENGINE_H
+
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+
+#include "Dictionary.h"
+#include "NgramModel.h"
+
+namespace UnivKbd {
+
+    /**
+     * @class SuggestionEngine
+     *
+     * @brief Computes the suggestions of the keyboard on the thread the engine lives in.
+     *
+     * Each keystroke submits a query with query(), which returns immediately. The queries are run in order on the
+     * thread of the engine, and a query is dropped without being computed when a more recent one has already been
+     * submitted, so a burst of keystrokes only computes the suggestions of the last one. The results are delivered
+     * by the suggestionsReady() signal.
+     *
+     * The engine follows the typed word with a DictionaryCursor, so consecutive queries stay incremental.
+     */
+    class SuggestionEngine : public QObject {
+    Q_OBJECT
+
+    public:
+        /**
+         * @brief Constructs an engine without dictionary nor next word model.
+         */
+        explicit SuggestionEngine(QObject *parent = nullptr);
+
+        /**
+         * @brief Submits a query for the suggestions of a word. Thread-safe.
+         *
+         * @param word The word being typed. When it is empty, the next word is predicted if predictNextWord is true.
+         * @param previousWords The words typed before, the last one being the closest.
+         * @param specials The suggestions to show before the computed ones.
+         * @param maxResults The maximum number of suggestions, including the specials.
+         * @param predictNextWord True to predict the next word when the word is empty.
+         * @return The generation of the query, given back by suggestionsReady().
+         */
+        quint64 query(const QString &word, const QStringList &previousWords, const QStringList &specials, int maxResults, bool predictNextWord);
+
+        /**
+         * @brief Returns the generation of the last submitted query. Thread-safe.
+         */
+        inline quint64 latestGeneration() const {
+            return mGeneration.load();
+        }
+
+        /**
+         * @brief Sets the dictionary used to complete the words. Thread-safe.
+         *
+         * The dictionary is replaced on the thread of the engine, before the queries submitted afterwards are run. The
+         * last query is then run again with the new dictionary, under a new generation.
+         *
+         * @param dictionary The dictionary, or nullptr to stop completing the words.
+         */
+        void setDictionary(std::shared_ptr<const Dictionary> dictionary);
+
+        /**
+         * @brief Loads the model used to predict the next word. Thread-safe.
+         *
+         * @param path The path of the model file.
+         * @return True on success.
+         * @see NgramModel::fromFile
+         */
+        bool loadNgramModel(const QString &path);
+
+        /**
+         * @brief Saves the next word model, including the words learned from the user. Thread-safe.
+         *
+         * @param path The path of the binary model file.
+         * @return True on success.
+         */
+        bool saveNgramModel(const QString &path) const;
+
+        /**
+         * @brief Learns a word committed by the user. Thread-safe.
+         *
+         * @param previousWords The words typed before, the last one being the closest.
+         * @param word The committed word.
+         */
+        void learn(const QStringList &previousWords, const QString &word);
+
+    signals:
+        /**
+         * @brief This signal is emitted on the thread of the engine when the suggestions of a query are computed.
+         *
+         * @param generation The generation of the query, as returned by query().
+         * @param suggestions The suggestions.
+         */
+        void suggestionsReady(quint64 generation, const QStringList &suggestions);
+
+    private:
+        void run(quint64 generation, const QString &word, const QStringList &previousWords, const QStringList &specials, int maxResults, bool predictNextWord);
+
+    private:
+        struct Query {
+            bool valid = false;
+            quint64 generation = 0;
+            QString word;
+            QStringList previousWords;
+            QStringList specials;
+            int maxResults = 0;
+            bool predictNextWord = false;
+        };
+
+    private:
+        std::atomic<quint64> mGeneration{0};
+
+        // only used on the thread of the engine
+        std::shared_ptr<const Dictionary> mDictionary;
+        DictionaryCursor mDictionaryCursor;
+        Query mLastQuery;
+
+        mutable QMutex mNgramMutex;
+        NgramModel mNgramModel;
+    };
+
+}
+
+#endif // UNIVKBD_SUGGESTIONENGINE_H
@@ -46,11 +46,14 @@ UnivKbd::VirtualKeyboard::VirtualKeyboard(QWidget *parent, VirtualKeyboardAttach
     connect(gInnerWidget, &VirtualKeyboardInnerWidget::virtualKeyPressed, this, &VirtualKeyboard::onVirtualKeyPressed, Qt::DirectConnection);
     connect(gInnerWidget, &VirtualKeyboardInnerWidget::specialKeyPressed, this, &VirtualKeyboard::onSpecialKeyPressed, Qt::DirectConnection);
     connect(gInnerWidget, &VirtualKeyboardInnerWidget::suggestionPressed, this, &VirtualKeyboard::onSuggestionPressed);
+    connect(gInnerWidget, &VirtualKeyboardInnerWidget::dictionaryLoaded, this, &VirtualKeyboard::dictionaryLoaded);
     connect(qApp, &QApplication::focusChanged, this, &VirtualKeyboard::onAppFocusChanged);
 
 }
 
-void UnivKbd::VirtualKeyboard::onVirtualKeyPressed(VirtualKeyboardButton *button, const Key &key) {
+void UnivKbd::VirtualKeyboard::onVirtualKeyPressed(VirtualKeyboardButton *button, const KeyHandle &key) {
+
+    (void)button;
 
     if (gCurrentKeyboard != this) {
         return;
@@ -69,10 +72,9 @@ void UnivKbd::VirtualKeyboard::onVirtualKeyPressed(VirtualKeyboardButton *button
     default:
         if (key.getCharacters().size() == 0) {
             event = new QKeyEvent(QEvent::KeyPress, (int)key.toQtKey(), getModifiers(), "");
-        } else if (button != nullptr) {
-            event = new QKeyEvent(QEvent::KeyPress, (int)key.toQtKey(), getModifiers(), key.getCharacters()[button->getCurrentKey()]);
         } else {
-            event = new QKeyEvent(QEvent::KeyPress, (int)key.toQtKey(), getModifiers(), key.getCharacters()[0]);
+            // the same level for the keys with a button and for the keys painted by a VirtualKeyboardView
+            event = new QKeyEvent(QEvent::KeyPress, (int)key.toQtKey(), getModifiers(), key.getCharacters()[gInnerWidget->currentLevel(key)]);
         }
         break;
 
@@ -82,7 +84,7 @@ void UnivKbd::VirtualKeyboard::onVirtualKeyPressed(VirtualKeyboardButton *button
 }
 
 
-void UnivKbd::VirtualKeyboard::onSpecialKeyPressed(UnivKbd::VirtualKeyboardButton &button, const UnivKbd::Key &key, const QString &special) {
+void UnivKbd::VirtualKeyboard::onSpecialKeyPressed(UnivKbd::VirtualKeyboardButton &button, const UnivKbd::KeyHandle &key, const QString &special) {
 
     (void)button;
 
@@ -111,6 +111,16 @@ namespace UnivKbd {
          */
         void attachToCurrentWindowAsDockWidget();
 
+        /**
+         * @brief Sets how the keys are drawn.
+         *
+         * @param mode VirtualKeyboardRenderMode::Painter draws all the keys from a single widget, which is lighter on
+         * embedded devices. VirtualKeyboardRenderMode::Widgets, the default, uses a button per key.
+         */
+        inline void setRenderMode(VirtualKeyboardRenderMode mode) {
+            gInnerWidget->setRenderMode(mode);
+        }
+
         /**
          * @brief Set the suggestions words to be displayed on top of the keyboard.
          */
@@ -118,6 +128,44 @@ namespace UnivKbd {
             gInnerWidget->setSuggestions(suggestions);
         }
 
+        /**
+         * @brief Loads the dictionary used for the suggestions in the background.
+         *
+         * @param path The path of the dictionary file.
+         * @see VirtualKeyboardInnerWidget::loadDictionary
+         */
+        inline void loadDictionary(const QString &path) {
+            gInnerWidget->loadDictionary(path);
+        }
+
+        /**
+         * @brief Returns true once the dictionary used for the suggestions is loaded.
+         */
+        inline bool isDictionaryLoaded() const {
+            return gInnerWidget->isDictionaryLoaded();
+        }
+
+        /**
+         * @brief Loads the model used to predict the next word after a space.
+         *
+         * @param path The path of the model file.
+         * @return True on success.
+         * @see VirtualKeyboardInnerWidget::loadNgramModel
+         */
+        inline bool loadNgramModel(const QString &path) {
+            return gInnerWidget->loadNgramModel(path);
+        }
+
+        /**
+         * @brief Saves the next word model, including the words learned from the user.
+         *
+         * @param path The path of the binary model file.
+         * @return True on success.
+         */
+        inline bool saveNgramModel(const QString &path) const {
+            return gInnerWidget->saveNgramModel(path);
+        }
+
     public slots:
         /**
          * @brief Sets the enabled state of the virtual keyboard.
@@ -131,6 +179,18 @@ namespace UnivKbd {
          */
         void triggerSetEnabled();
 
+    signals:
+        /**
+         * @brief This signal is emitted when the dictionary used for the suggestions is ready to be used.
+         *
+         * The keyboard can be used before, but without suggestions. This allows applications to measure the time
+         * until the keyboard is fully interactive.
+         *
+         * @param success False if the dictionary file could not be read, or if the language has no dictionary.
+         * @param elapsed The time spent loading the dictionary, in milliseconds.
+         */
+        void dictionaryLoaded(bool success, qint64 elapsed);
+
     protected:
         void findWindowAndAttachDockWidget();
 
@@ -139,9 +199,9 @@ namespace UnivKbd {
 
         void parentLooseFocus();
 
-        void onVirtualKeyPressed(VirtualKeyboardButton *button, const Key &key);
+        void onVirtualKeyPressed(VirtualKeyboardButton *button, const KeyHandle &key);
 
-        void onSpecialKeyPressed(VirtualKeyboardButton &button, const Key &key, const QString &special);
+        void onSpecialKeyPressed(VirtualKeyboardButton &button, const KeyHandle &key, const QString &special);
 
         void onSuggestionPressed(const QString &suggestion, const QString &wordToReplace);
 
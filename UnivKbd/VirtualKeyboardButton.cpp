@@ -22,8 +22,9 @@
 */
 
 #include "VirtualKeyboardButton.h"
+#include "IconCache.h"
+#include "KeycapCache.h"
 
-#include <QFile>
 #include <QKeyEvent>
 #include <QLabel>
 #include <QTimer>
@@ -33,61 +34,51 @@
 
 #include <unordered_set>
 
-UnivKbd::VirtualKeyboardButton::VirtualKeyboardButton(const Key &key, std::shared_ptr<QFont> font, QWidget *parent) : QAbstractButton(parent), mKey(key), mFont(font) {
-
-    switch (key.getType()) {
-
-        case KeyType::REGULAR:
-            mKeyString[0] = key.toString(0);
-            mKeyString[1] = key.toString(1);
-            mKeyString[2] = key.toString(2);
-
-            break;
-
-        default:
-            mKeyString[0] = key.toString();
-            mKeyString[1] = key.toString();
-            mKeyString[2] = key.toString();
-            setCheckable(true);
-            break;
-
-    }
+UnivKbd::VirtualKeyboardButton::VirtualKeyboardButton(const KeyHandle &key, std::shared_ptr<QFont> font, QWidget *parent) : QAbstractButton(parent), mFont(font) {
 
     connect(this, &QAbstractButton::pressed, this, &VirtualKeyboardButton::virtualButtonPressed);
 
-    setCurrentKey(0);
-
     // set minimum height
     setMinimumHeight(50);
 
+    setKey(key);
 
-    QString svgPath = ":/" + QString::fromStdString(std::to_string((int)mKey.getType())) + ".svg";
-    QFile svgFile(svgPath);
+}
 
-    if (svgFile.open(QIODevice::ReadOnly)) {
-        mPixmap = QPixmap(svgPath);
-    }
+UnivKbd::VirtualKeyboardButton::~VirtualKeyboardButton() {
 
 }
 
-UnivKbd::VirtualKeyboardButton::~VirtualKeyboardButton() {
+void UnivKbd::VirtualKeyboardButton::setKey(const KeyHandle &key) {
+    mKey = key;
+
+    setChecked(false);
+    setCheckable(key.getType() != KeyType::REGULAR);
+    mCurrentKey = 0;
+    setText(key.getLabel(0));
+
+    // the icons are probed and rendered once for all the buttons
+    mHasIcon = IconCache::instance().hasIcon(key.getType());
 
+    update();
 }
 
 void UnivKbd::VirtualKeyboardButton::virtualButtonPressed() {
     emit virtualKeyPressed(this, mKey);
 }
 
-void UnivKbd::VirtualKeyboardButton::setCurrentKey(int index) {
-    int maxIndex = 0;
-    for (; maxIndex < 2; maxIndex++) {
-        if (mKeyString[maxIndex + 1] == "") {
-            break;
-        }
+bool UnivKbd::VirtualKeyboardButton::setCurrentKey(int level) {
+    // the labels of all the levels are precomputed by the model, no string is built here
+    const QString &label = mKey.getLabel(level);
+    if (level == mCurrentKey || label == mKey.getLabel(mCurrentKey)) {
+        mCurrentKey = level;
+        return false;
     }
 
-    mCurrentKey = std::min(maxIndex, index);
-    setText(mKeyString[index]);
+    // setText() only repaints this button
+    mCurrentKey = level;
+    setText(label);
+    return true;
 }
 
 void UnivKbd::VirtualKeyboardButton::paintFromParent(QPainter &painter, bool fromParent) {
@@ -100,34 +91,27 @@ void UnivKbd::VirtualKeyboardButton::paintFromParent(QPainter &painter, bool fro
         rect = QRect(0, 0, width(), height());
     }
 
-    // Draw the background according to the button's state (hover, pressed, checked, etc.)
+    // the key is rendered once per label, size and state, and blitted afterwards
+    KeycapState state = KeycapState::Normal;
     if (isDown())
     {
-        painter.fillRect(rect, QColor(0xCC, 0xCC, 0xCC));
+        state = KeycapState::Down;
     }
     else if (isChecked())
     {
-        painter.fillRect(rect, QColor(0xFF, 0xCC, 0x99));
+        state = KeycapState::Checked;
     }
     else if (underMouse())
     {
-        painter.fillRect(rect, QColor(0xCC, 0xCC, 0xCC));
+        state = KeycapState::Hovered;
     }
-    else
-    {
-        painter.fillRect(rect, QColor(0xFF, 0xFF, 0xFF));
-    }
-
-    if (mPixmap.isNull()) {
-        painter.setPen(Qt::black);
-        painter.drawText(rect, Qt::AlignCenter, text());
-    } else {
-        QRect svgSize = mPixmap.rect();
-        qreal svgHeight = mFont->pointSizeF() * 0.8;
-        qreal svgWidth = svgHeight * svgSize.width() / svgSize.height();
 
-        QRect svgRect(rect.center().x() - svgWidth / 2, rect.center().y() - svgHeight / 2, svgWidth, svgHeight);
-        painter.drawPixmap(svgRect, mPixmap);
+    qreal devicePixelRatio = painter.device()->devicePixelRatioF();
+    QPixmap icon;
+    if (mHasIcon && mFont != nullptr) {
+        icon = IconCache::instance().icon(mKey.getType(), mFont->pointSizeF() * 0.8, devicePixelRatio);
     }
+    QPixmap keycap = KeycapCache::keycap(text(), icon, rect.size(), state, painter.font(), devicePixelRatio);
+    painter.drawPixmap(rect.topLeft(), keycap);
 
 }
\ No newline at end of file
@@ -42,6 +42,7 @@
 #include <utility>
 
 #include "Keyboard.h"
+#include "KeyboardModel.h"
 
 namespace UnivKbd {
 
@@ -49,19 +50,41 @@ namespace UnivKbd {
     Q_OBJECT
 
     public:
-        VirtualKeyboardButton(const Key &key, std::shared_ptr<QFont> font, QWidget *parent);
+        VirtualKeyboardButton(const KeyHandle &key, std::shared_ptr<QFont> font, QWidget *parent);
         ~VirtualKeyboardButton() override;
 
-        void setCurrentKey(int index);
+        /**
+         * @brief Shows another key on the button, so that it can be reused when the layout changes.
+         *
+         * @param key The new key.
+         */
+        void setKey(const KeyHandle &key);
+
+        /**
+         * @brief Shows the label of the key at the modifier level of the current modifiers.
+         *
+         * @param level The modifier level, see Key::level().
+         * @return True if the label changed, in which case the button is repainted.
+         */
+        bool setCurrentKey(int level);
 
         inline int getCurrentKey() const {
             return mCurrentKey;
         }
 
-        inline const Key &getKey() const {
+        inline const KeyHandle &getKey() const {
             return mKey;
         }
 
+        /**
+         * @brief Releases the key of a button kept aside for later reuse, and the model it belongs to.
+         *
+         * The button must be given a key with setKey() before it is shown again.
+         */
+        inline void clearKey() {
+            mKey = KeyHandle();
+        }
+
         //qreal recommendedTextSize() const;
 
         //inline void setTextSize(float size) {
@@ -82,20 +105,19 @@ namespace UnivKbd {
         }
 
     signals:
-        void virtualKeyPressed(VirtualKeyboardButton *button, const Key &key);
+        void virtualKeyPressed(VirtualKeyboardButton *button, const KeyHandle &key);
 
-        void specialKeyPressed(VirtualKeyboardButton &button, const Key &key, const QString &special);
+        void specialKeyPressed(VirtualKeyboardButton &button, const KeyHandle &key, const QString &special);
 
     private slots:
         void virtualButtonPressed();
 
     private:
-        Key mKey;
-        QString mKeyString[3];
+        KeyHandle mKey;
 
-        int mCurrentKey;
+        int mCurrentKey = 0;  // the modifier level of the label
 
-        QPixmap mPixmap;
+        bool mHasIcon = false;
 
         std::shared_ptr<QFont> mFont;
 
@@ -22,6 +22,7 @@
 */
 
 #include "VirtualKeyboardInnerWidget.h"
+#include "CharacterClass.h"
 
 #include <QFile>
 #include <QKeyEvent>
@@ -30,6 +31,8 @@
 #include <QMainWindow>
 #include <QDockWidget>
 #include <QPainter>
+#include <QThread>
+#include <QElapsedTimer>
 
 #include <unordered_set>
 
@@ -40,6 +43,23 @@ UnivKbd::VirtualKeyboardInnerWidget::VirtualKeyboardInnerWidget() {
     mMainLayout = new QStackedLayout();
     setLayout(mMainLayout);
 
+    // the keys can be delivered through queued connections, the signals name the type without its namespace
+    qRegisterMetaType<KeyHandle>("KeyHandle");
+    qRegisterMetaType<KeyHandle>("UnivKbd::KeyHandle");
+
+    mSuggestionThread = new QThread(this);
+    mSuggestionEngine = new SuggestionEngine();
+    mSuggestionEngine->moveToThread(mSuggestionThread);
+    connect(mSuggestionThread, &QThread::finished, mSuggestionEngine, &QObject::deleteLater);
+    connect(mSuggestionEngine, &SuggestionEngine::suggestionsReady, this, [=](quint64 generation, const QStringList &suggestions) {
+        // the word changed since this query was submitted
+        if (generation != mSuggestionEngine->latestGeneration()) {
+            return;
+        }
+        setSuggestions(suggestions);
+    });
+    mSuggestionThread->start();
+
     mKeyboardWithSuggestionsLayout = new QVBoxLayout();
     mKeyboardWithSuggestionsLayout->setSpacing(2);
 
@@ -62,12 +82,17 @@ UnivKbd::VirtualKeyboardInnerWidget::VirtualKeyboardInnerWidget() {
     mKeyboardWidget->setLayout(mKeyboardWithSuggestionsLayout);
 
     mMainLayout->addWidget(mKeyboardWidget);
+    mKeyboardWidget->installEventFilter(this);
 
     mConfigurationWidget = new VirtualKeyboardConfigurationWidget();
     mMainLayout->addWidget(mConfigurationWidget);
     connect(mConfigurationWidget, &VirtualKeyboardConfigurationWidget::requestKeyboard, [=](const QString &country, const QString &layout) {
-        Keyboard keyboard = Keyboard::importKeyboard(country, layout);
-        loadLayoutFromKeyboard(keyboard);
+        // switching back to a recent keyboard does not import and convert it again
+        std::shared_ptr<const Keyboard> keyboard = KeyboardCache::instance().load(country, layout);
+        if (keyboard != nullptr) {
+            loadLayoutFromKeyboard(*keyboard);
+        }
+        loadDictionaryForKeyboard(country);
     });
     connect(mConfigurationWidget, &VirtualKeyboardConfigurationWidget::close, [=]() {
         mMainLayout->setCurrentWidget(mKeyboardWidget);
@@ -82,60 +107,219 @@ UnivKbd::VirtualKeyboardInnerWidget::VirtualKeyboardInnerWidget() {
 
     mMainLayout->setCurrentWidget(mKeyboardWidget);
 
-    Keyboard keyboard = Keyboard::importKeyboard("US", "qwertyuiopasdfghjklzxcvbnm");
-    loadLayoutFromKeyboard(keyboard);
+    std::shared_ptr<const Keyboard> keyboard = KeyboardCache::instance().load("US", "qwertyuiopasdfghjklzxcvbnm");
+    if (keyboard != nullptr) {
+        loadLayoutFromKeyboard(*keyboard);
+    }
+
+    // map the dictionary compiled from dictionaries/English.txt, without delaying the first show of the keyboard
+    loadDictionaryForKeyboard("US");
 
-    // fill mDictionary with work from :/dictionary.txt
-    QFile dictionaryFile(":/dictionary.txt");
-    if (dictionaryFile.open(QIODevice::ReadOnly)) {
-        QTextStream in(&dictionaryFile);
-        while (!in.atEnd()) {
-            QString line = in.readLine();
-            mDictionary << line;
+}
+
+UnivKbd::VirtualKeyboardInnerWidget::~VirtualKeyboardInnerWidget() {
+    mSuggestionThread->quit();
+    mSuggestionThread->wait();
+
+    // a dictionary cannot be interrupted while it is parsed, the loads still running are awaited and their result
+    // is dropped
+    for (const auto &thread : mDictionaryThreads) {
+        if (!thread.isNull()) {
+            disconnect(thread, nullptr, this, nullptr);
+            thread->wait();
         }
-    } else {
-        qDebug() << "Could not open dictionary file";
-        exit(1);
     }
+}
 
+void UnivKbd::VirtualKeyboardInnerWidget::loadDictionary(const QString &path) {
+    loadDictionaryInBackground([path]() -> std::shared_ptr<const Dictionary> {
+        bool success = false;
+        auto dictionary = std::make_shared<const Dictionary>(Dictionary::fromFile(path, &success));
+        return success ? dictionary : nullptr;
+    }, path);
+}
+
+void UnivKbd::VirtualKeyboardInnerWidget::loadDictionaryForKeyboard(const QString &keyboard) {
+    QString language = DictionaryCache::languageForKeyboard(keyboard);
+
+    std::shared_ptr<const Dictionary> dictionary = DictionaryCache::instance().find(language);
+    if (dictionary != nullptr) {
+        // cancel any load still running
+        ++mDictionaryGeneration;
+        setDictionary(dictionary);
+        emit dictionaryLoaded(true, 0);
+        return;
+    }
+
+    // do not suggest words of the previous language while the new one is loading
+    setDictionary(nullptr);
+    loadDictionaryInBackground([language]() {
+        return DictionaryCache::instance().load(language);
+    }, DictionaryCache::dictionaryPath(language));
+}
+
+bool UnivKbd::VirtualKeyboardInnerWidget::loadNgramModel(const QString &path) {
+    return mSuggestionEngine->loadNgramModel(path);
+}
+
+void UnivKbd::VirtualKeyboardInnerWidget::loadDictionaryInBackground(std::function<std::shared_ptr<const Dictionary>()> loader, const QString &name) {
+    quint64 generation = ++mDictionaryGeneration;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // the worker only writes the result, which is read back on this thread once the worker has finished
+    auto result = std::make_shared<std::shared_ptr<const Dictionary>>();
+    QThread *thread = QThread::create([result, loader]() {
+        *result = loader();
+    });
+    // owned by the widget, so that it is deleted with it if the widget is destroyed during the load
+    thread->setParent(this);
+    mDictionaryThreads.append(thread);
+
+    connect(thread, &QThread::finished, this, [=]() {
+        mDictionaryThreads.removeAll(thread);
+
+        // a more recent request superseded this one
+        if (generation != mDictionaryGeneration) {
+            return;
+        }
+
+        if (*result == nullptr) {
+            qDebug() << "Could not open dictionary file" << name;
+        } else {
+            setDictionary(*result);
+        }
+        emit dictionaryLoaded(*result != nullptr, timer.elapsed());
+    });
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    thread->start(QThread::LowPriority);
+}
+
+void UnivKbd::VirtualKeyboardInnerWidget::setDictionary(std::shared_ptr<const Dictionary> dictionary) {
+    mDictionary = std::move(dictionary);
+    mSuggestionEngine->setDictionary(mDictionary);
 }
 
 bool UnivKbd::VirtualKeyboardInnerWidget::loadLayoutFromKeyboard(const Keyboard& keyboard) {
 
-    // empty the layout
-    for (const auto& button : mButtons) {
+    // the buttons still showing the keys of the previous model keep it alive through their handles
+    mKeyboardModel = std::make_shared<const KeyboardModel>(keyboard);
+
+    if (mRenderMode == VirtualKeyboardRenderMode::Painter) {
+        mKeyboardView->setModel(mKeyboardModel);
+    } else {
+        updateButtons();
+    }
+
+    return true;
+}
+
+void UnivKbd::VirtualKeyboardInnerWidget::setRenderMode(VirtualKeyboardRenderMode mode) {
+    if (mode == mRenderMode) {
+        return;
+    }
+    mRenderMode = mode;
+
+    if (mode == VirtualKeyboardRenderMode::Painter) {
+        // the buttons are kept in the spare pool, in case the mode is switched back
+        while (!mButtons.isEmpty()) {
+            VirtualKeyboardButton *button = mButtons.takeLast();
+            mKeyboardLayout->removeWidget(button);
+            button->hide();
+            button->clearKey();
+            mSpareButtons.append(button);
+        }
+
+        if (mKeyboardView.isNull()) {
+            mKeyboardView = new VirtualKeyboardView(this);
+            connect(mKeyboardView, &VirtualKeyboardView::keyPressed, this, [=](const KeyHandle &key) {
+                onVirtualKeyPressed(nullptr, key);
+            });
+            mKeyboardWithSuggestionsLayout->addWidget(mKeyboardView);
+        }
+        mKeyboardView->setModel(mKeyboardModel);
+        mKeyboardView->show();
+    } else {
+        mKeyboardView->hide();
+        mKeyboardView->setModel(nullptr);
+        updateButtons();
+    }
+
+    refreshModifiers();
+}
+
+void UnivKbd::VirtualKeyboardInnerWidget::updateButtons() {
+
+    // most layouts share the same geometry: the buttons of the keys that did not move only get their new key,
+    // without being created or placed in the grid again
+    int reused = std::min((int)mButtons.size(), mKeyboardModel->size());
+    for (int i = 0; i < reused; i++) {
+        KeyHandle key = mKeyboardModel->key(i);
+        VirtualKeyboardButton *button = mButtons[i];
+        const KeyHandle &previousKey = button->getKey();
+        bool moved = previousKey.getX() != key.getX() || previousKey.getY() != key.getY() ||
+                     previousKey.getXSpan() != key.getXSpan() || previousKey.getYSpan() != key.getYSpan();
+        button->setKey(key);
+        if (moved) {
+            mKeyboardLayout->removeWidget(button);
+            placeButton(button);
+        }
+    }
+
+    // the buttons left over are kept for the next layouts with more keys
+    while (mButtons.size() > mKeyboardModel->size()) {
+        VirtualKeyboardButton *button = mButtons.takeLast();
         mKeyboardLayout->removeWidget(button);
-        delete button;
+        button->hide();
+        // do not keep the model of the previous layout alive
+        button->clearKey();
+        mSpareButtons.append(button);
     }
-    mButtons.clear();
 
-    for (const auto& key : keyboard.getKeys()) {
-        addButtonFromKey(key);
+    for (int i = reused; i < mKeyboardModel->size(); i++) {
+        addButtonFromKey(mKeyboardModel->key(i));
     }
 
-    return true;
+    // the new keys show their first character
+    mShownLevel = 0;
 }
 
-void UnivKbd::VirtualKeyboardInnerWidget::addButtonFromKey(const Key &key) {
+void UnivKbd::VirtualKeyboardInnerWidget::addButtonFromKey(const KeyHandle &key) {
+    VirtualKeyboardButton *btn;
+    if (!mSpareButtons.isEmpty()) {
+        btn = mSpareButtons.takeLast();
+        btn->setKey(key);
+        btn->setFont(mKeyFont);
+        btn->show();
+    } else {
+        btn = new VirtualKeyboardButton(key, mKeyFont, this);
+        // fit the button to the size of the layout
+        btn->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+        connect(btn, &VirtualKeyboardButton::virtualKeyPressed, this, &VirtualKeyboardInnerWidget::onVirtualKeyPressed);
+        connect(btn, &VirtualKeyboardButton::specialKeyPressed, this, &VirtualKeyboardInnerWidget::onSpecialKeyPressed);
+    }
+
+    placeButton(btn);
+    mButtons.append(btn);
+}
+
+void UnivKbd::VirtualKeyboardInnerWidget::placeButton(VirtualKeyboardButton *button) {
 
     const int spanResolution = 4;
 
+    const KeyHandle &key = button->getKey();
     int x = key.getX() * spanResolution;
     int y = key.getY() * spanResolution;
     int spanx = key.getXSpan() * spanResolution;
     int spany = key.getYSpan() * spanResolution;
 
-    VirtualKeyboardButton *btn = new VirtualKeyboardButton(key, nullptr, this);
-    // fit the button to the size of the layout
-    btn->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-
-    connect(btn, &VirtualKeyboardButton::virtualKeyPressed, this, &VirtualKeyboardInnerWidget::onVirtualKeyPressed);
-    connect(btn, &VirtualKeyboardButton::specialKeyPressed, this, &VirtualKeyboardInnerWidget::onSpecialKeyPressed);
-    mKeyboardLayout->addWidget(btn, y, x, spany, spanx);
-    mButtons.append(btn);
+    mKeyboardLayout->addWidget(button, y, x, spany, spanx);
 }
 
-void UnivKbd::VirtualKeyboardInnerWidget::onVirtualKeyPressed(VirtualKeyboardButton *button, const Key &key) {
+void UnivKbd::VirtualKeyboardInnerWidget::onVirtualKeyPressed(VirtualKeyboardButton *button, const KeyHandle &key) {
 
     qDebug() << "Pressed : " << key.getCharacters();
 
@@ -152,8 +336,7 @@ void UnivKbd::VirtualKeyboardInnerWidget::onVirtualKeyPressed(VirtualKeyboardBut
         case KeyType::SHIFT:
         case KeyType::ALT:
         case KeyType::CTRL:
-            assert(button != nullptr);
-            pressModifier(key);
+            pressModifier(key.getType());
             refreshModifiers(button);
             break;
 
@@ -163,28 +346,36 @@ void UnivKbd::VirtualKeyboardInnerWidget::onVirtualKeyPressed(VirtualKeyboardBut
 
     emit virtualKeyPressed(button, key); // admitting there is a direct connection
 
-    // if the key is a character, add it to the current word
-    if (key.getCharacters().size() > 0 && key.getCharacters()[0] >= 'a' && key.getCharacters()[0] <= 'z') {
-        mCurrentWord += key.getCharacters()[0];
+    // if the key is a character of a word, add it to the current word. Joiners, like apostrophes and hyphens,
+    // only belong to a word when they follow its first character.
+    CharacterClass characterClass = key.getType() == KeyType::REGULAR ? UnivKbd::characterClass(key.getCharacters()) : CharacterClass::Boundary;
+    if (characterClass == CharacterClass::Word || (characterClass == CharacterClass::Joiner && mCurrentWord.length() > 0)) {
+        // keep both halves of the characters outside of the BMP. The characters are copied, since they view the
+        // labels of the keyboard model.
+        const QString &characters = key.getCharacters();
+        mCurrentWord.append(characters.constData(), characters.size() >= 2 && characters[0].isHighSurrogate() ? 2 : 1);
     } else if (key.getType() == KeyType::BACKSPACE) {
         if (mCurrentWord.length() > 0) {
             mCurrentWord = mCurrentWord.left(mCurrentWord.length() - 1);
         }
     } else {
-        mCurrentWord = "";
-    }
-
-    QStringList suggestions = key.getSpecials(0);
-
-    if (mCurrentWord != "") {
-        for (const auto& word : mDictionary) {
-            if (word.startsWith(mCurrentWord)) {
-                suggestions << word;
+        if (key.getType() == KeyType::SPACE) {
+            // the word is complete, it becomes the context of the next one
+            if (mCurrentWord.length() > 0) {
+                mPreviousWords << mCurrentWord;
+                if (mPreviousWords.size() > 2) {
+                    mPreviousWords.removeFirst();
+                }
             }
+        } else if (key.getType() == KeyType::ENTER || (key.getCharacters().size() > 0 && key.getCharacters()[0].isPunct())) {
+            // a new sentence does not follow the previous words
+            mPreviousWords.clear();
         }
+        mCurrentWord = "";
     }
 
-    setSuggestions(suggestions);
+    // the suggestions are computed on the suggestion thread, and shown once they are ready
+    mSuggestionEngine->query(mCurrentWord, mPreviousWords, key.getSpecials(0), 10, key.getType() == KeyType::SPACE);
 
 
     switch (key.getType()) {
@@ -195,20 +386,16 @@ void UnivKbd::VirtualKeyboardInnerWidget::onVirtualKeyPressed(VirtualKeyboardBut
             break;
 
         default:
-            if (button != nullptr) {
-                if (key.getCharacters().size() == 0) {
-                } else {
-                    mKeyModifier = 0;
-                    refreshModifiers(button);
-                }
+            if (key.getCharacters().size() == 0) {
+            } else {
+                mKeyModifier = 0;
+                refreshModifiers(button);
             }
             break;
     }
-
-    update();
 }
 
-void UnivKbd::VirtualKeyboardInnerWidget::onSpecialKeyPressed(VirtualKeyboardButton &button, const Key &key, const QString &special) {
+void UnivKbd::VirtualKeyboardInnerWidget::onSpecialKeyPressed(VirtualKeyboardButton &button, const KeyHandle &key, const QString &special) {
     emit specialKeyPressed(button, key, special);
     mKeyModifier = 0;
     refreshModifiers(&button);
@@ -228,18 +415,54 @@ void UnivKbd::VirtualKeyboardInnerWidget::triggerSetEnabled() {
 }
 
 void UnivKbd::VirtualKeyboardInnerWidget::refreshModifiers(QObject *toIgnore) {
+    // only the keys whose label or checked state changes are repainted, each in its own rect. The labels of the
+    // regular keys are left alone when the level is the same, and setChecked() does nothing when the state is the same.
+    int level = (int)currentKeyType();
+    bool levelChanged = level != mShownLevel;
+    mShownLevel = level;
+
     for (auto button : mButtons) {
-        if (button->getKey().getType() == KeyType::REGULAR) {
-            button->setCurrentKey(currentKeyType());
+        KeyType type = button->getKey().getType();
+        if (type == KeyType::REGULAR) {
+            if (levelChanged) {
+                button->setCurrentKey(level);
+            }
         } else if (button != toIgnore) {
-            button->setChecked(isModifierPressed(button->getKey()));
+            button->setChecked(isModifierPressed(type));
         }
     }
+    if (!mKeyboardView.isNull()) {
+        mKeyboardView->setModifiers((int)currentKeyType(), mKeyModifier);
+    }
 }
 
 void UnivKbd::VirtualKeyboardInnerWidget::paintEvent(QPaintEvent *event) {
     (void)event;
 
+    // the font only depends on the geometry of the keys, hovering or pressing a key does not change it
+    if (mKeyFontDirty || devicePixelRatioF() != mKeyFontPixelRatio) {
+        updateKeyFont();
+    }
+
+    // the keys are all painted from a single widget in the VirtualKeyboardRenderMode::Painter mode, see
+    // VirtualKeyboardView
+}
+
+bool UnivKbd::VirtualKeyboardInnerWidget::eventFilter(QObject *watched, QEvent *event) {
+    // the buttons are resized when the keyboard widget is resized or laid out again
+    if (watched == mKeyboardWidget && (event->type() == QEvent::Resize || event->type() == QEvent::LayoutRequest)) {
+        mKeyFontDirty = true;
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void UnivKbd::VirtualKeyboardInnerWidget::updateKeyFont() {
+    mKeyFontDirty = false;
+
+    if (mButtons.isEmpty()) {
+        return;
+    }
+
     // Compute minimal rect with and height
     int minWidth = std::numeric_limits<int>::max();
     int minHeight = std::numeric_limits<int>::max();
@@ -249,6 +472,12 @@ void UnivKbd::VirtualKeyboardInnerWidget::paintEvent(QPaintEvent *event) {
         minHeight = std::min(minHeight, button->rect().height());
     }
 
+    QSize keySize(minWidth, minHeight);
+    if (mKeyFont != nullptr && keySize == mKeyFontKeySize && devicePixelRatioF() == mKeyFontPixelRatio) {
+        return;
+    }
+    mKeyFontKeySize = keySize;
+    mKeyFontPixelRatio = devicePixelRatioF();
 
     // Calculate the font size based on the button's dimensions and text width
     std::shared_ptr<QFont> font = std::make_shared<QFont>();
@@ -273,21 +502,15 @@ void UnivKbd::VirtualKeyboardInnerWidget::paintEvent(QPaintEvent *event) {
 
     font->setPointSizeF(fontPointSize);
 
+    mKeyFont = font;
     for (auto button : mButtons) {
         button->setFont(font);
     }
-
-    // draw each button from here
-    //QPainter painter(this);
-    //painter.setFont(*font);
-    //for (const auto& button : mButtons) {
-    //    button->paintFromParent(painter);
-    //}
-    
 }
 
 void UnivKbd::VirtualKeyboardInnerWidget::onSuggestionsButtonPressed(int suggestionIndex) {
-    if (mSuggestionButtons[suggestionIndex]->text() == "") {
+    QString suggestion = mSuggestionButtons[suggestionIndex]->text();
+    if (suggestion == "") {
         return;
     }
 
@@ -295,21 +518,14 @@ void UnivKbd::VirtualKeyboardInnerWidget::onSuggestionsButtonPressed(int suggest
     mKeyModifier = 0;
     refreshModifiers();
 
-    lockSuggestions();
+    qDebug() << "Replacing " << mCurrentWord << " with " << suggestion;
 
-    qDebug() << "Replacing " << mCurrentWord << " with " << mSuggestionButtons[suggestionIndex]->text();
+    mSuggestionEngine->learn(mPreviousWords, suggestion);
 
-    QString currentWord = mCurrentWord;
+    // the word is replaced at once in the application, instead of replaying a key press per character
+    QString wordToReplace = mCurrentWord;
+    mCurrentWord = suggestion;
+    emit suggestionPressed(suggestion, wordToReplace);
 
-    for (int i = 0; i < currentWord.size(); i++) {
-        onVirtualKeyPressed(nullptr, Key(KeyType::BACKSPACE));
-    }
-
-    for (int i = 0; i < mSuggestionButtons[suggestionIndex]->text().size(); i++) {
-        onVirtualKeyPressed(nullptr, Key(mSuggestionButtons[suggestionIndex]->text()[i]));
-        qDebug() << "current word is : " << mCurrentWord;
-    }
-
-    unlockSuggestions();
-
-}
\ No newline at end of file
+    mSuggestionEngine->query(mCurrentWord, mPreviousWords, QStringList(), 10, false);
+}
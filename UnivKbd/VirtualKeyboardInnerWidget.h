@@ -37,15 +37,33 @@
 #include <QList>
 #include <QComboBox>
 #include <QStackedLayout>
+#include <QThread>
 
+#include <functional>
+#include <memory>
 #include <unordered_set>
 
 #include "VirtualKeyboardButton.h"
+#include "VirtualKeyboardView.h"
 #include "Keyboard.h"
+#include "KeyboardCache.h"
+#include "KeyboardModel.h"
+#include "Dictionary.h"
+#include "DictionaryCache.h"
+#include "NgramModel.h"
+#include "SuggestionEngine.h"
 #include "VirtualKeyboardConfigurationWidget.h"
 
 namespace UnivKbd {
 
+    /**
+     * @brief How the keys of the virtual keyboard are drawn.
+     */
+    enum class VirtualKeyboardRenderMode {
+        Widgets,  ///< A VirtualKeyboardButton widget per key.
+        Painter   ///< A single VirtualKeyboardView painting all the keys, for devices with little CPU and GPU.
+    };
+
     /**
      * @class VirtualKeyboardInnerWidget
      *
@@ -63,6 +81,7 @@ namespace UnivKbd {
          * @param parent The parent widget with which the keyboard will be associated. When this widget will be in focus, the keyboard will be shown. automatically
          */
         VirtualKeyboardInnerWidget();
+        ~VirtualKeyboardInnerWidget() override;
 
         /**
          * @brief Returns the Qt keyboard modifiers.
@@ -83,6 +102,24 @@ namespace UnivKbd {
             return modifiers;
         }
 
+        /**
+         * @brief Sets how the keys are drawn.
+         *
+         * @param mode The render mode, VirtualKeyboardRenderMode::Widgets by default.
+         */
+        void setRenderMode(VirtualKeyboardRenderMode mode);
+
+        inline VirtualKeyboardRenderMode getRenderMode() const {
+            return mRenderMode;
+        }
+
+        /**
+         * @brief Returns the index of the character of a key typed with the current modifiers.
+         */
+        inline int currentLevel(const KeyHandle &key) const {
+            return std::max(0, std::min((int)currentKeyType(), (int)key.getCharacters().size() - 1));
+        }
+
         /**
          * @brief Set the suggestions words to be displayed on top of the keyboard.
          */
@@ -119,6 +156,60 @@ namespace UnivKbd {
             mSuggestionLocked = false;
         }
 
+        /**
+         * @brief Loads the dictionary used for the suggestions in the background.
+         *
+         * The dictionary is parsed on a worker thread, and replaces the current one once it is ready. Until then,
+         * the keyboard keeps using the previous dictionary, or shows no suggestion at all.
+         *
+         * @param path The path of the dictionary file, either in the text or in the binary format.
+         * @see Dictionary::fromFile
+         * @see dictionaryLoaded
+         */
+        void loadDictionary(const QString &path);
+
+        /**
+         * @brief Switches the suggestions to the language of a keyboard layout.
+         *
+         * The dictionary is taken from DictionaryCache, and loaded in the background if it is not in memory yet.
+         * The suggestions of the previous language stop immediately, and none are shown for layouts whose language
+         * has no dictionary.
+         *
+         * @param keyboard The name of the keyboard layout.
+         * @see DictionaryCache::languageForKeyboard
+         * @see dictionaryLoaded
+         */
+        void loadDictionaryForKeyboard(const QString &keyboard);
+
+        /**
+         * @brief Loads the model used to predict the next word after a word boundary.
+         *
+         * The words learned since the previous model was loaded are discarded, unless they were saved with
+         * saveNgramModel().
+         *
+         * @param path The path of the model file, preferably in the binary format, which is mapped in memory.
+         * @return True on success.
+         * @see NgramModel::fromFile
+         */
+        bool loadNgramModel(const QString &path);
+
+        /**
+         * @brief Saves the next word model, including the words learned from the user.
+         *
+         * @param path The path of the binary model file.
+         * @return True on success.
+         */
+        inline bool saveNgramModel(const QString &path) const {
+            return mSuggestionEngine->saveNgramModel(path);
+        }
+
+        /**
+         * @brief Returns true once a dictionary has been loaded.
+         */
+        inline bool isDictionaryLoaded() const {
+            return mDictionary != nullptr;
+        }
+
     public slots:
         /**
          * @brief Sets the enabled state of the virtual keyboard.
@@ -141,7 +232,7 @@ namespace UnivKbd {
          * @param button The button that was pressed.
          * @param key The associated key to the button that was pressed.
          */
-        void virtualKeyPressed(VirtualKeyboardButton *button, const Key &key);
+        void virtualKeyPressed(VirtualKeyboardButton *button, const KeyHandle &key);
 
         /**
          * @brief This signal is emitted when a special key is pressed on the virtual keyboard.
@@ -150,51 +241,80 @@ namespace UnivKbd {
          * @param key The associated key to the button that was pressed.
          * @param special The special key that was pressed.
          */
-        void specialKeyPressed(VirtualKeyboardButton &button, const Key &key, const QString &special);
+        void specialKeyPressed(VirtualKeyboardButton &button, const KeyHandle &key, const QString &special);
 
         /**
          * @brief This signal is emitted when a suggestion is pressed on the virtual keyboard.
          *
          * @param suggestion The suggestion that was pressed.
+         * @param wordToReplace The word being typed, which the suggestion replaces.
          */
         void suggestionPressed(const QString &suggestion, const QString &wordToReplace);
 
+        /**
+         * @brief This signal is emitted when a dictionary requested with loadDictionary() or
+         * loadDictionaryForKeyboard() is ready to be used.
+         *
+         * @param success False if the dictionary file could not be read, or if the language has no dictionary.
+         * @param elapsed The time spent loading the dictionary, in milliseconds.
+         */
+        void dictionaryLoaded(bool success, qint64 elapsed);
+
     protected:
         void paintEvent(QPaintEvent *event) override;
 
+        bool eventFilter(QObject *watched, QEvent *event) override;
+
     private slots:
-        void onVirtualKeyPressed(VirtualKeyboardButton *button, const Key &key);
+        void onVirtualKeyPressed(VirtualKeyboardButton *button, const KeyHandle &key);
 
-        void onSpecialKeyPressed(VirtualKeyboardButton &button, const Key &key, const QString &special);
+        void onSpecialKeyPressed(VirtualKeyboardButton &button, const KeyHandle &key, const QString &special);
 
     private:
         bool loadLayoutFromKeyboard(const Keyboard &keyboard);
 
-        void addButtonFromKey(const Key &key);
+        void addButtonFromKey(const KeyHandle &key);
+
+        void placeButton(VirtualKeyboardButton *button);
+
+        void updateButtons();
+
+        void updateKeyFont();
 
-        inline void pressModifier(const Key &key) {
-            mKeyModifier ^= (unsigned long)1 << (int)key.getType();
+        inline void pressModifier(KeyType type) {
+            mKeyModifier ^= (unsigned long)1 << (int)type;
         }
 
-        inline bool isModifierPressed(const Key &key) const {
-            return (mKeyModifier & ((unsigned long)1 << (int)key.getType())) != 0;
+        inline bool isModifierPressed(KeyType type) const {
+            return (mKeyModifier & ((unsigned long)1 << (int)type)) != 0;
         }
 
+        /**
+         * @brief Returns the modifier level of the pressed modifiers, the Alt key acting as AltGr.
+         */
         inline unsigned long currentKeyType() const {
-            unsigned long type = 0;
-            if (isModifierPressed(KeyType::SHIFT) || isModifierPressed(KeyType::CAPS_LOCK)) {
-                type += (unsigned long)KeyType::SHIFT + 1;
-            }
-            if (isModifierPressed(KeyType::ALT)) {
-                type += (unsigned long)KeyType::ALT + 1;
-            }
-            return type;
+            return (unsigned long)Key::level(isModifierPressed(KeyType::SHIFT) || isModifierPressed(KeyType::CAPS_LOCK),
+                                             isModifierPressed(KeyType::ALT));
         }
 
         void refreshModifiers(QObject *toIgnore = nullptr);
 
+        void loadDictionaryInBackground(std::function<std::shared_ptr<const Dictionary>()> loader, const QString &name);
+
+        void setDictionary(std::shared_ptr<const Dictionary> dictionary);
+
     private:
         QList<QPointer<VirtualKeyboardButton>> mButtons;
+        QList<QPointer<VirtualKeyboardButton>> mSpareButtons;  // hidden, out of the layout, reused before creating new ones
+        QPointer<VirtualKeyboardView> mKeyboardView;
+
+        // the font of the keys, computed for the smallest key and the device pixel ratio it was computed with
+        std::shared_ptr<QFont> mKeyFont;
+        QSize mKeyFontKeySize;
+        qreal mKeyFontPixelRatio = 0;
+        bool mKeyFontDirty = true;
+        VirtualKeyboardRenderMode mRenderMode = VirtualKeyboardRenderMode::Widgets;
+        std::shared_ptr<const KeyboardModel> mKeyboardModel;  // the keys of the buttons
 
         QPointer<QStackedLayout> mMainLayout;
         QPointer<QWidget> mKeyboardWidget;
@@ -206,14 +326,21 @@ namespace UnivKbd {
         QPointer<QPushButton> mSuggestionButtons[10];
 
         unsigned long mKeyModifier = 0;
+        int mShownLevel = 0;  // the level of the labels shown on the buttons of the regular keys
         QKeySequence mKeySequence;
 
         bool mIsEnabled = true;
 
         bool mSuggestionLocked = false;
 
-        QStringList mDictionary;
+        std::shared_ptr<const Dictionary> mDictionary;
+        quint64 mDictionaryGeneration = 0;
         QString mCurrentWord;
+        QStringList mPreviousWords;
+
+        QPointer<QThread> mSuggestionThread;
+        QList<QPointer<QThread>> mDictionaryThreads;  // the dictionary loads still running, awaited on destruction
+        QPointer<SuggestionEngine> mSuggestionEngine;
     };
 
 }
@@ -0,0 +1,211 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#include "VirtualKeyboardView.h"
+#include "IconCache.h"
+#include "KeycapCache.h"
+
+#include <QFontMetrics>
+#include <QMouseEvent>
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+UnivKbd::VirtualKeyboardView::VirtualKeyboardView(QWidget *parent) : QWidget(parent) {
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    setMouseTracking(true);
+}
+
+void UnivKbd::VirtualKeyboardView::setModel(std::shared_ptr<const KeyboardModel> model) {
+    mModel = std::move(model);
+    mPressedKey = -1;
+    mHoveredKey = -1;
+    if (mModel != nullptr) {
+        // the same minimum height as the buttons, 50 pixels per row
+        setMinimumHeight(int(std::ceil(mModel->height())) * 50);
+    }
+    updateFont();
+    update();
+}
+
+void UnivKbd::VirtualKeyboardView::setModifiers(int level, unsigned long checkedTypes) {
+    if (level == mLevel && checkedTypes == mCheckedTypes) {
+        return;
+    }
+    int previousLevel = mLevel;
+    unsigned long changedTypes = checkedTypes ^ mCheckedTypes;
+    mLevel = level;
+    mCheckedTypes = checkedTypes;
+
+    if (mModel == nullptr) {
+        return;
+    }
+
+    // only the keys whose label or checked state changes are repainted, a Shift tap leaves the digits, the
+    // symbols without a shifted character and most of the special keys untouched
+    for (int i = 0; i < mModel->size(); i++) {
+        KeyType type = mModel->type(i);
+        if (type == KeyType::REGULAR) {
+            if (previousLevel != level && mModel->label(i, previousLevel) != mModel->label(i, level)) {
+                updateKey(i);
+            }
+        } else if ((changedTypes & ((unsigned long)1 << (int)type)) != 0) {
+            updateKey(i);
+        }
+    }
+}
+
+int UnivKbd::VirtualKeyboardView::keyAt(const QPointF &position) const {
+    if (mModel == nullptr || width() == 0 || height() == 0) {
+        return -1;
+    }
+    return mModel->keyAt(float(position.x() * mModel->width() / width()), float(position.y() * mModel->height() / height()));
+}
+
+QRectF UnivKbd::VirtualKeyboardView::keyRect(int index) const {
+    qreal keyWidth = width() / qreal(mModel->width());
+    qreal keyHeight = height() / qreal(mModel->height());
+
+    // the same spacing as the grid layout of the buttons
+    return QRectF(mModel->x(index) * keyWidth, mModel->y(index) * keyHeight, mModel->xSpan(index) * keyWidth, mModel->ySpan(index) * keyHeight).adjusted(1, 1, -1, -1);
+}
+
+void UnivKbd::VirtualKeyboardView::updateKey(int index) {
+    if (index >= 0) {
+        update(keyRect(index).toAlignedRect());
+    }
+}
+
+void UnivKbd::VirtualKeyboardView::updateFont() {
+    if (mModel == nullptr || mModel->size() == 0) {
+        return;
+    }
+
+    // the same size as the font of the buttons, computed from the smallest key
+    qreal minWidth = std::numeric_limits<qreal>::max();
+    qreal minHeight = std::numeric_limits<qreal>::max();
+    for (int i = 0; i < mModel->size(); i++) {
+        QRectF rect = keyRect(i);
+        minWidth = std::min(minWidth, rect.width());
+        minHeight = std::min(minHeight, rect.height());
+    }
+
+    qreal maxFontSize = qMin(0.6 * minWidth, 0.6 * minHeight);
+    qreal fontPointSize = 0.8 * maxFontSize;
+    if (fontPointSize <= 0) {
+        return;
+    }
+    mFont.setPointSizeF(fontPointSize);
+
+    QFontMetrics fontMetrics(mFont);
+    qreal textWidth = fontMetrics.horizontalAdvance("F10");
+    if (textWidth > 0.6 * minWidth) {
+        fontPointSize *= (0.6 * minWidth) / textWidth;
+    }
+    if (fontPointSize > maxFontSize) {
+        fontPointSize = maxFontSize;
+    }
+    mFont.setPointSizeF(fontPointSize);
+}
+
+void UnivKbd::VirtualKeyboardView::paintEvent(QPaintEvent *event) {
+    if (mModel == nullptr) {
+        return;
+    }
+
+    QPainter painter(this);
+
+    for (int i = 0; i < mModel->size(); i++) {
+        QRectF rect = keyRect(i);
+        if (!event->rect().intersects(rect.toAlignedRect())) {
+            continue;
+        }
+
+        // the key is rendered once per label, size and state, and blitted afterwards
+        KeyType type = mModel->type(i);
+        bool checked = type != KeyType::REGULAR && (mCheckedTypes & ((unsigned long)1 << (int)type)) != 0;
+        KeycapState state = KeycapState::Normal;
+        if (i == mPressedKey) {
+            state = KeycapState::Down;
+        } else if (checked) {
+            state = KeycapState::Checked;
+        } else if (i == mHoveredKey) {
+            state = KeycapState::Hovered;
+        }
+
+        QRect bounds = rect.toRect();
+        QPixmap icon = IconCache::instance().icon(type, mFont.pointSizeF() * 0.8, devicePixelRatioF());
+        const QString &label = icon.isNull() ? mModel->label(i, mLevel) : QString();
+        painter.drawPixmap(bounds.topLeft(), KeycapCache::keycap(label, icon, bounds.size(), state, mFont, devicePixelRatioF()));
+    }
+}
+
+void UnivKbd::VirtualKeyboardView::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    updateFont();
+}
+
+void UnivKbd::VirtualKeyboardView::mousePressEvent(QMouseEvent *event) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    int key = keyAt(event->position());
+#else
+    int key = keyAt(event->localPos());
+#endif
+    if (key < 0) {
+        return;
+    }
+
+    mPressedKey = key;
+    updateKey(key);
+
+    // like the buttons, the key is sent when it is pressed
+    emit keyPressed(mModel->key(key));
+}
+
+void UnivKbd::VirtualKeyboardView::mouseReleaseEvent(QMouseEvent *event) {
+    Q_UNUSED(event)
+    int key = mPressedKey;
+    mPressedKey = -1;
+    updateKey(key);
+}
+
+void UnivKbd::VirtualKeyboardView::mouseMoveEvent(QMouseEvent *event) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    int key = keyAt(event->position());
+#else
+    int key = keyAt(event->localPos());
+#endif
+    if (key != mHoveredKey) {
+        updateKey(mHoveredKey);
+        mHoveredKey = key;
+        updateKey(mHoveredKey);
+    }
+}
+
+void UnivKbd::VirtualKeyboardView::leaveEvent(QEvent *event) {
+    Q_UNUSED(event)
+    updateKey(mHoveredKey);
+    mHoveredKey = -1;
+}
@@ -0,0 +1,114 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+#ifndef VIRTUALKEYBOARDVIEW_H
+#define VIRTUALKEYBOARDVIEW_H
+
+#include <QFont>
+#include <QRectF>
+#include <QWidget>
+
+#include <memory>
+#include <vector>
+
+#include "KeyboardModel.h"
+
+namespace UnivKbd {
+
+    /**
+     * @class VirtualKeyboardView
+     *
+     * @brief Paints all the keys of a keyboard in a single widget.
+     *
+     * This is the lightweight alternative to a VirtualKeyboardButton per key: there is no child widget, the keys are
+     * painted in one pass, and a press is routed to its key with KeyboardModel::keyAt().
+     *
+     * @see VirtualKeyboardRenderMode
+     */
+    class VirtualKeyboardView : public QWidget {
+    Q_OBJECT
+
+    public:
+        explicit VirtualKeyboardView(QWidget *parent = nullptr);
+
+        /**
+         * @brief Sets the keys to paint.
+         *
+         * @param model The keys, or nullptr to paint nothing.
+         */
+        void setModel(std::shared_ptr<const KeyboardModel> model);
+
+        inline const std::shared_ptr<const KeyboardModel> &getModel() const {
+            return mModel;
+        }
+
+        /**
+         * @brief Sets the state of the modifiers.
+         *
+         * @param level The modifier level of the labels, see Key::level().
+         * @param checkedTypes The mask of the key types shown as checked, one bit per KeyType.
+         */
+        void setModifiers(int level, unsigned long checkedTypes);
+
+    signals:
+        /**
+         * @brief This signal is emitted when a key is pressed.
+         */
+        void keyPressed(const KeyHandle &key);
+
+    protected:
+        void paintEvent(QPaintEvent *event) override;
+
+        void resizeEvent(QResizeEvent *event) override;
+
+        void mousePressEvent(QMouseEvent *event) override;
+
+        void mouseReleaseEvent(QMouseEvent *event) override;
+
+        void mouseMoveEvent(QMouseEvent *event) override;
+
+        void leaveEvent(QEvent *event) override;
+
+    private:
+        int keyAt(const QPointF &position) const;
+
+        QRectF keyRect(int index) const;
+
+        void updateKey(int index);
+
+        void updateFont();
+
+    private:
+        std::shared_ptr<const KeyboardModel> mModel;
+
+        int mLevel = 0;
+        unsigned long mCheckedTypes = 0;
+        int mPressedKey = -1;
+        int mHoveredKey = -1;
+
+        QFont mFont;
+    };
+
+}
+
+#endif
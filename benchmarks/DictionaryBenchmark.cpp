@@ -0,0 +1,206 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+/*
+ * Measures the cost of computing the suggestions for one keystroke, for dictionaries growing from 1k to 1M words.
+ * The dictionaries start with a real word list, ranked first, and are padded with generated words up to their size.
+ * Every sampled word is typed character by character, and each prefix is completed as the keyboard does.
+ * The linear scan over a QStringList that the keyboard used before the prefix index is measured as a reference, and
+ * the completions of the index are checked against it for every prefix of a sample of the words, so that a
+ * regression in the index shows up as a failure instead of a faster timing.
+ * Typo correction is measured on the same words with one substituted character, with its 2 ms per keystroke budget.
+ *
+ * Usage: DictionaryBenchmark [word list]
+ * The word list has the format of the text dictionaries, one word per line from the most to the least frequent,
+ * and defaults to dictionaries/English.txt. A list shorter than 1M words is padded with generated ones.
+ */
+
+#include "../UnivKbd/Dictionary.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+static QStringList loadWords(const QString &path) {
+    QStringList words;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return words;
+    }
+
+    // the frequencies are ignored, the words are ranked by their position like the linear scan does
+    QSet<QString> seen;
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        QString word = stream.readLine().section(QRegularExpression("[\\t ]"), 0, 0).trimmed();
+        if (!word.isEmpty() && !seen.contains(word)) {
+            seen.insert(word);
+            words << word;
+        }
+    }
+    return words;
+}
+
+static void padWords(QStringList &words, int count, std::mt19937 &random) {
+    std::uniform_int_distribution<int> length(2, 12);
+    std::uniform_int_distribution<int> letter(0, 25);
+
+    QSet<QString> seen;
+    for (const auto &word : words) {
+        seen.insert(word);
+    }
+    words.reserve(count);
+    while (words.size() < count) {
+        QString word(length(random), Qt::Uninitialized);
+        for (auto &character : word) {
+            character = QChar('a' + letter(random));
+        }
+        if (!seen.contains(word)) {
+            seen.insert(word);
+            words << word;
+        }
+    }
+}
+
+static QStringList linearComplete(const QStringList &words, const QString &prefix, int maxResults) {
+    QStringList results;
+    for (const auto &word : words) {
+        if (word.startsWith(prefix)) {
+            results << word;
+        }
+    }
+    return results.mid(0, maxResults);
+}
+
+int main(int argc, char *argv[]) {
+    const int sampleCount = 200;
+    const int linearSampleCount = 10;
+    const int checkSampleCount = 20;
+    const int maxWordCount = 1000000;
+
+    QString path = argc > 1 ? QString::fromLocal8Bit(argv[1]) : QString(UNIVKBD_BENCHMARK_WORD_LIST);
+    QStringList allWords = loadWords(path);
+    if (allWords.isEmpty()) {
+        std::fprintf(stderr, "Cannot read the word list %s\n", qPrintable(path));
+        return 1;
+    }
+    std::mt19937 padRandom(42);
+    padWords(allWords, maxWordCount, padRandom);
+
+    std::printf("%10s %12s %14s %16s %15s %19s %10s\n", "words", "build (ms)", "trie (ns/key)", "linear (ns/key)", "fuzzy (ns/key)", "fuzzy max (ns/key)", "mismatches");
+
+    int totalMismatches = 0;
+
+    for (int wordCount = 1000; wordCount <= maxWordCount; wordCount *= 10) {
+        std::mt19937 random(42);
+        QStringList words = allWords.mid(0, wordCount);
+
+        QElapsedTimer timer;
+        timer.start();
+        UnivKbd::Dictionary dictionary(words);
+        qint64 buildTime = timer.elapsed();
+
+        std::uniform_int_distribution<int> pick(0, wordCount - 1);
+        QStringList samples;
+        for (int i = 0; i < sampleCount; i++) {
+            samples << words[pick(random)];
+        }
+
+        // keep the results alive so the queries are not optimized away
+        qint64 resultCount = 0;
+
+        qint64 keystrokes = 0;
+        timer.restart();
+        for (const auto &sample : samples) {
+            for (int length = 1; length <= sample.size(); length++) {
+                resultCount += dictionary.complete(sample.left(length), 10).size();
+                keystrokes++;
+            }
+        }
+        qint64 trieTime = timer.nsecsElapsed() / keystrokes;
+
+        qint64 linearKeystrokes = 0;
+        timer.restart();
+        for (int i = 0; i < linearSampleCount; i++) {
+            const QString &sample = samples[i];
+            for (int length = 1; length <= sample.size(); length++) {
+                resultCount += linearComplete(words, sample.left(length), 10).size();
+                linearKeystrokes++;
+            }
+        }
+        qint64 linearTime = timer.nsecsElapsed() / linearKeystrokes;
+
+        // the index must return the same words, in the same order, as the scan it replaces
+        int mismatches = 0;
+        for (int i = 0; i < checkSampleCount; i++) {
+            const QString &sample = samples[i];
+            for (int length = 1; length <= sample.size(); length++) {
+                QString prefix = sample.left(length);
+                QStringList expected = linearComplete(words, prefix, 10);
+                QStringList actual = dictionary.complete(prefix, 10);
+                if (actual != expected) {
+                    if (mismatches == 0) {
+                        std::fprintf(stderr, "%d words, \"%s\": expected \"%s\", got \"%s\"\n", wordCount, qPrintable(prefix),
+                                     qPrintable(expected.join(' ')), qPrintable(actual.join(' ')));
+                    }
+                    mismatches++;
+                }
+            }
+        }
+        totalMismatches += mismatches;
+
+        qint64 fuzzyKeystrokes = 0;
+        qint64 fuzzyTime = 0;
+        qint64 fuzzyMaxTime = 0;
+        for (auto sample : samples) {
+            if (sample.size() < 2) {
+                continue;
+            }
+            int middle = sample.size() / 2;
+            sample[middle] = sample[middle] == QChar('e') ? QChar('a') : QChar('e');
+            for (int length = 2; length <= sample.size(); length++) {
+                timer.restart();
+                resultCount += dictionary.completeFuzzy(sample.left(length), 10, length < 5 ? 1 : 2, 2000000).size();
+                qint64 time = timer.nsecsElapsed();
+                fuzzyTime += time;
+                fuzzyMaxTime = std::max(fuzzyMaxTime, time);
+                fuzzyKeystrokes++;
+            }
+        }
+        fuzzyTime /= std::max<qint64>(fuzzyKeystrokes, 1);
+
+        std::printf("%10d %12lld %14lld %16lld %15lld %19lld %10d\n", wordCount, (long long)buildTime, (long long)trieTime, (long long)linearTime, (long long)fuzzyTime, (long long)fuzzyMaxTime, mismatches);
+
+        if (resultCount == 0) {
+            std::printf("no result\n");
+        }
+    }
+
+    return totalMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+/*
+ * Loads every layout listed by Keyboard::listExportedKeyboards() from the tables compiled into the library, and checks
+ * that the names are sorted for the binary search and that each of them can be found and imported.
+ * Exits with a non-zero status if any layout cannot be found or imported.
+ */
+
+#include "../UnivKbd/Keyboard.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <cstdio>
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    UNIVKBD_INIT_RESOURCE();
+
+    QList<QString> names = UnivKbd::Keyboard::listExportedKeyboards();
+    if (names.isEmpty()) {
+        std::fprintf(stderr, "No keyboard is compiled into the library\n");
+        return 1;
+    }
+
+    // the static table is searched with a binary search
+    bool sorted = std::is_sorted(names.begin(), names.end());
+    if (!sorted) {
+        std::fprintf(stderr, "The names of the keyboards are not sorted\n");
+    }
+
+    int failures = 0;
+    for (const auto &name : names) {
+        if (UnivKbd::Keyboard::findStaticKeyboard(name) == nullptr) {
+            std::fprintf(stderr, "Cannot find the compiled keyboard \"%s\"\n", qPrintable(name));
+            failures++;
+            continue;
+        }
+
+        UnivKbd::Keyboard keyboard = UnivKbd::Keyboard::importKeyboard(name, UnivKbd::getKeyboardLayouts()[0]);
+        if (keyboard.getKeys().empty()) {
+            std::fprintf(stderr, "Cannot import the compiled keyboard \"%s\"\n", qPrintable(name));
+            failures++;
+        }
+    }
+
+    if (UnivKbd::Keyboard::findStaticKeyboard("Not a keyboard") != nullptr) {
+        std::fprintf(stderr, "An unknown keyboard is found\n");
+        failures++;
+    }
+
+    std::printf("%d of %d keyboards loaded\n", (int)names.size() - failures, (int)names.size());
+    return sorted && failures == 0 ? 0 : 1;
+}
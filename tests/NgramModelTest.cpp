@@ -0,0 +1,128 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+/*
+ * Saves a small n-gram model in the binary format, and checks that it loads back, then that copies of it with a
+ * corrupted entry or word offset are rejected by NgramModel::fromBinaryFile instead of being read out of bounds.
+ * Exits with a non-zero status if any check fails.
+ */
+
+#include "../UnivKbd/NgramModel.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include <cstdio>
+#include <cstring>
+
+static bool writeFile(const QString &path, const QByteArray &data) {
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+static quint32 readField(const QByteArray &data, qint64 offset) {
+    quint32 value;
+    std::memcpy(&value, data.constData() + offset, sizeof(value));
+    return qFromLittleEndian(value);
+}
+
+static void writeField(QByteArray &data, qint64 offset, quint32 value) {
+    value = qToLittleEndian(value);
+    std::memcpy(data.data() + offset, &value, sizeof(value));
+}
+
+static bool loads(const QString &path) {
+    bool ok = true;
+    UnivKbd::NgramModel::fromBinaryFile(path, &ok);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::fprintf(stderr, "Cannot create a temporary directory\n");
+        return 1;
+    }
+
+    UnivKbd::NgramModel model({{{"the", "cat"}, 10}, {{"the", "dog"}, 5}, {{"a", "cat", "sat"}, 3}});
+    QString validPath = directory.filePath("valid.ngram");
+    if (!model.saveBinaryFile(validPath)) {
+        std::fprintf(stderr, "Cannot save the model\n");
+        return 1;
+    }
+
+    QFile file(validPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "Cannot read the saved model\n");
+        return 1;
+    }
+    QByteArray valid = file.readAll();
+    file.close();
+
+    int failures = 0;
+    if (!loads(validPath)) {
+        std::fprintf(stderr, "The valid model is rejected\n");
+        failures++;
+    }
+
+    const qint64 headerSize = (qint64)sizeof(UnivKbd::NgramHeader);
+    quint32 entryCount = readField(valid, 8);
+    quint32 wordCount = readField(valid, 12);
+    qint64 entriesOffset = headerSize;
+    qint64 offsetsOffset = headerSize + (qint64)entryCount * (qint64)sizeof(UnivKbd::NgramEntry);
+
+    // an entry predicting a word past the end of the vocabulary
+    QByteArray badEntry = valid;
+    quint32 wordAndCount = readField(badEntry, entriesOffset + 4);
+    writeField(badEntry, entriesOffset + 4, (wordAndCount & 0xff000000u) | wordCount);
+    QString badEntryPath = directory.filePath("entry.ngram");
+    if (!writeFile(badEntryPath, badEntry) || loads(badEntryPath)) {
+        std::fprintf(stderr, "The model with a corrupted entry is not rejected\n");
+        failures++;
+    }
+
+    // a word starting after the end of the characters
+    QByteArray badOffset = valid;
+    writeField(badOffset, offsetsOffset, 0xfffffff0u);
+    QString badOffsetPath = directory.filePath("offset.ngram");
+    if (!writeFile(badOffsetPath, badOffset) || loads(badOffsetPath)) {
+        std::fprintf(stderr, "The model with a corrupted offset is not rejected\n");
+        failures++;
+    }
+
+    // the last offset is past the end of the file
+    QByteArray truncated = valid.left((int)(offsetsOffset + ((qint64)wordCount + 1) * 4));
+    QString truncatedPath = directory.filePath("truncated.ngram");
+    if (!writeFile(truncatedPath, truncated) || loads(truncatedPath)) {
+        std::fprintf(stderr, "The truncated model is not rejected\n");
+        failures++;
+    }
+
+    std::printf("%d n-gram model checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+/*
+ * Generates the two-stage table of the character classes of the Basic Multilingual Plane, used to find the words
+ * being typed. The classes are taken from the Unicode database of the Qt version the keyboard is built with.
+ *
+ * Usage: UnivKbdCharacterClassGenerator <CharacterClassTable.h>
+ */
+
+#include <QChar>
+#include <QFile>
+#include <QString>
+#include <QTextStream>
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+// must match UnivKbd::CharacterClass
+enum {
+    Boundary = 0,
+    Word = 1,
+    Joiner = 2
+};
+
+static int characterClass(char16_t unit) {
+    switch (unit) {
+        case 0x0027: // apostrophe
+        case 0x002D: // hyphen-minus
+        case 0x00AD: // soft hyphen
+        case 0x00B7: // middle dot, Catalan
+        case 0x05F3: // Hebrew geresh
+        case 0x05F4: // Hebrew gershayim
+        case 0x2010: // hyphen
+        case 0x2011: // non-breaking hyphen
+        case 0x2019: // right single quotation mark, typographic apostrophe
+        case 0x200C: // zero width non-joiner
+        case 0x200D: // zero width joiner
+            return Joiner;
+        default:
+            break;
+    }
+
+    QChar character(unit);
+    if (character.isLetterOrNumber() || character.isMark()) {
+        return Word;
+    }
+    return Boundary;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "Usage: %s <CharacterClassTable.h>\n", argv[0]);
+        return 1;
+    }
+
+    // each block holds the 2-bit classes of 256 characters, identical blocks are stored once
+    std::vector<int> stage1(256);
+    std::vector<std::vector<int>> blocks;
+    std::map<std::vector<int>, int> blockIndices;
+    for (int high = 0; high < 256; high++) {
+        std::vector<int> block(64, 0);
+        for (int low = 0; low < 256; low++) {
+            block[low / 4] |= characterClass((char16_t)(high * 256 + low)) << ((low % 4) * 2);
+        }
+        auto it = blockIndices.find(block);
+        if (it == blockIndices.end()) {
+            it = blockIndices.emplace(block, (int)blocks.size()).first;
+            blocks.push_back(block);
+        }
+        stage1[high] = it->second;
+    }
+
+    QFile file(QString::fromLocal8Bit(argv[1]));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "Could not write %s\n", argv[1]);
+        return 1;
+    }
+
+    QTextStream out(&file);
+    out << "// Generated by UnivKbdCharacterClassGenerator, do not edit.\n\n";
+    out << "#ifndef UNIVKBD_CHARACTERCLASSTABLE_H\n";
+    out << "#define UNIVKBD_CHARACTERCLASSTABLE_H\n\n";
+    out << "#include <QtGlobal>\n\n";
+    out << "namespace UnivKbd {\n\n";
+    out << "    // index of the block of each group of 256 characters\n";
+    out << "    static const quint8 CharacterClassStage1[256] = {";
+    for (int i = 0; i < 256; i++) {
+        out << (i % 16 == 0 ? "\n        " : " ") << stage1[i] << ",";
+    }
+    out << "\n    };\n\n";
+    out << "    // the classes of the characters of each block, 4 per byte from the lowest bits\n";
+    out << "    static const quint8 CharacterClassStage2[" << blocks.size() << "][64] = {";
+    for (const auto &block : blocks) {
+        out << "\n        {";
+        for (int i = 0; i < 64; i++) {
+            out << (i % 16 == 0 ? "\n            " : " ") << block[i] << ",";
+        }
+        out << "\n        },";
+    }
+    out << "\n    };\n\n";
+    out << "}\n\n";
+    out << "#endif // UNIVKBD_CHARACTERCLASSTABLE_H\n";
+
+    return 0;
+}
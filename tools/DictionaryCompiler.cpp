@@ -0,0 +1,75 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+/*
+ * Converts a text dictionary or n-gram model into the binary format that the keyboard maps in memory.
+ *
+ * Usage: UnivKbdDictionaryCompiler <dictionary.txt> <dictionary.dict>
+ *        UnivKbdDictionaryCompiler <ngrams.txt> <ngrams.ngram>
+ */
+
+#include "../UnivKbd/Dictionary.h"
+#include "../UnivKbd/NgramModel.h"
+
+#include <cstdio>
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: %s <dictionary.txt> <dictionary.dict>\n", argv[0]);
+        std::fprintf(stderr, "       %s <ngrams.txt> <ngrams.ngram>\n", argv[0]);
+        return 1;
+    }
+
+    QString input = QString::fromLocal8Bit(argv[1]);
+    QString output = QString::fromLocal8Bit(argv[2]);
+
+    if (output.endsWith(".ngram")) {
+        bool ok = false;
+        UnivKbd::NgramModel model = UnivKbd::NgramModel::fromTextFile(input, &ok);
+        if (!ok) {
+            std::fprintf(stderr, "Could not read %s\n", argv[1]);
+            return 1;
+        }
+
+        if (!model.saveBinaryFile(output)) {
+            std::fprintf(stderr, "Could not write %s\n", argv[2]);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    bool ok = false;
+    UnivKbd::Dictionary dictionary = UnivKbd::Dictionary::fromTextFile(input, &ok);
+    if (!ok) {
+        std::fprintf(stderr, "Could not read %s\n", argv[1]);
+        return 1;
+    }
+
+    if (!dictionary.saveBinaryFile(output)) {
+        std::fprintf(stderr, "Could not write %s\n", argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
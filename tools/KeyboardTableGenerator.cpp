@@ -0,0 +1,215 @@
+/*
+* --------------------------------------------------------------
+* Project: UnivKbd
+* Author: Liza Belos
+* Year: 2023
+*
+* Copyright (c) 2023. All rights reserved.
+* This work is licensed under the terms of the MIT License.
+* For a copy, see <https://opensource.org/licenses/MIT>.
+* --------------------------------------------------------------
+*
+* NOTICE:
+* This file is part of the original distribution of the UnivKbd project.
+* All changes and redistributions of this file must retain this notice,
+* the list of contributors, and the entire copyright notice including the
+* MIT License information.
+*
+* DISCLAIMER:
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from
+* the use of this software.
+*/
+
+
+/*
+ * Compiles the .keyboard files and the specials.txt file of a directory into constexpr tables, so that the library
+ * can build its layouts without reading any file. Identical strings and layouts are stored once.
+ *
+ * Usage: UnivKbdKeyboardTableGenerator <keyboards directory> <StaticKeyboards.cpp>
+ */
+
+#include "../UnivKbd/Keyboard.h"
+
+#include <QHash>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+class StringTable {
+public:
+    UnivKbd::StaticString add(const QString &string) {
+        auto it = mOffsets.find(string);
+        if (it == mOffsets.end()) {
+            it = mOffsets.insert(string, (quint32)mCharacters.size());
+            for (QChar character : string) {
+                mCharacters.push_back(character.unicode());
+            }
+        }
+        return {it.value(), (quint32)string.size()};
+    }
+
+    const std::vector<quint16> &characters() const {
+        return mCharacters;
+    }
+
+private:
+    QHash<QString, quint32> mOffsets;
+    std::vector<quint16> mCharacters;
+};
+
+static QString toLiteral(float value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", (double)value);
+    QString literal = QString::fromLatin1(buffer);
+    if (!literal.contains('.') && !literal.contains('e') && !literal.contains('n') && !literal.contains('i')) {
+        literal += ".0";
+    }
+    return literal + "f";
+}
+
+static QString toLiteral(const UnivKbd::StaticString &string) {
+    return QString("{%1, %2}").arg(string.offset).arg(string.size);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: %s <keyboards directory> <StaticKeyboards.cpp>\n", argv[0]);
+        return 1;
+    }
+
+    QDir directory(QString::fromLocal8Bit(argv[1]));
+    QStringList names = directory.entryList(QStringList() << "*.keyboard", QDir::Files);
+    for (auto &name : names) {
+        name.chop(9);
+    }
+    // sorted the way Keyboard::findStaticKeyboard searches the names, without the .keyboard extension, since ' '
+    // and '(' sort before '.'
+    std::sort(names.begin(), names.end());
+
+    // same format and parsing as SpecialsTable::fromFile
+    std::map<QChar, QStringList> specials;
+    QFile specialsFile(directory.filePath("specials.txt"));
+    if (specialsFile.open(QIODevice::ReadOnly)) {
+        while (!specialsFile.atEnd()) {
+            QString line = specialsFile.readLine();
+            QStringList parts = line.split(":");
+            if (parts.size() != 2) {
+                continue;
+            }
+            QString key = parts[0].trimmed();
+            QStringList values = parts[1].split(",");
+            for (int i = 0; i < values.size(); i++) {
+                values[i] = values[i].trimmed();
+            }
+            specials[key.at(0)] = values;
+        }
+    }
+
+    StringTable strings;
+    QString keyArrays;
+    QHash<QString, int> keyArrayIndices;
+    QStringList keyboards;
+
+    for (const auto &name : names) {
+        QString file = name + ".keyboard";
+
+        bool ok = false;
+        UnivKbd::Keyboard keyboard = UnivKbd::Keyboard::fromFile(directory.filePath(file), &ok);
+        if (!ok) {
+            std::fprintf(stderr, "Could not read %s\n", qPrintable(directory.filePath(file)));
+            return 1;
+        }
+
+        // Keyboard::applySpecials only gives special characters to the first characters of a key
+        QString dropped;
+        for (const auto &key : keyboard.getKeys()) {
+            if (key.getType() != UnivKbd::KeyType::REGULAR) {
+                continue;
+            }
+            const QString &characters = key.getCharacters();
+            for (int j = UnivKbd::Key::MaxSpecials; j < (int)characters.size(); j++) {
+                if (specials.count(characters.at(j)) != 0) {
+                    dropped += characters.at(j);
+                }
+            }
+        }
+        if (!dropped.isEmpty()) {
+            std::fprintf(stderr, "Warning: the special characters of \"%s\" are dropped in %s, only the first %d characters of a key can have some\n",
+                         qPrintable(dropped), qPrintable(file), UnivKbd::Key::MaxSpecials);
+        }
+
+        QString keys;
+        for (const auto &key : keyboard.getKeys()) {
+            keys += QString("        {static_cast<UnivKbd::KeyType>(%1), %2, %3, %4, %5, %6},\n")
+                    .arg((int)key.getType())
+                    .arg(toLiteral(key.getXSpan()), toLiteral(key.getYSpan()), toLiteral(key.getX()), toLiteral(key.getY()))
+                    .arg(toLiteral(strings.add(key.getCharacters())));
+        }
+        if (keys.isEmpty()) {
+            // arrays cannot be empty
+            keys = "        {UnivKbd::KeyType::REGULAR, 0.0f, 0.0f, 0.0f, 0.0f, {0, 0}},\n";
+        }
+
+        // identical layouts share the same keys
+        auto index = keyArrayIndices.find(keys);
+        if (index == keyArrayIndices.end()) {
+            index = keyArrayIndices.insert(keys, keyArrayIndices.size());
+            keyArrays += QString("    constexpr UnivKbd::StaticKey Keys%1[] = {\n%2    };\n\n").arg(index.value()).arg(keys);
+        }
+
+        keyboards << QString("        {%1, Keys%2, %3},\n").arg(toLiteral(strings.add(name))).arg(index.value()).arg(keyboard.getKeys().size());
+    }
+
+    QString specialStrings;
+    QString specialsEntries;
+    int specialStringCount = 0;
+    for (const auto &special : specials) {
+        specialsEntries += QString("        {0x%1, %2, %3},\n").arg(special.first.unicode(), 4, 16, QChar('0')).arg(specialStringCount).arg(special.second.size());
+        for (const auto &value : special.second) {
+            specialStrings += QString("        %1,\n").arg(toLiteral(strings.add(value)));
+            specialStringCount++;
+        }
+    }
+    if (specialsEntries.isEmpty()) {
+        specialsEntries = "        {0, 0, 0},\n";
+    }
+    if (specialStrings.isEmpty()) {
+        specialStrings = "        {0, 0},\n";
+    }
+
+    QString characters;
+    for (std::size_t i = 0; i < strings.characters().size(); i++) {
+        characters += (i % 16 == 0 ? "\n        " : " ") + QString("0x%1,").arg(strings.characters()[i], 4, 16, QChar('0'));
+    }
+    // arrays cannot be empty
+    characters += "\n        0x0000,";
+
+    QFile output(QString::fromLocal8Bit(argv[2]));
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "Could not write %s\n", argv[2]);
+        return 1;
+    }
+
+    QTextStream out(&output);
+    out << "// Generated by UnivKbdKeyboardTableGenerator, do not edit.\n\n";
+    out << "#include \"Keyboard.h\"\n\n";
+    out << "namespace {\n\n";
+    out << "    constexpr char16_t Strings[] = {" << characters << "\n    };\n\n";
+    out << keyArrays;
+    out << "    constexpr UnivKbd::StaticKeyboard Keyboards[] = {\n" << keyboards.join("") << "    };\n\n";
+    out << "    constexpr UnivKbd::StaticString SpecialStrings[] = {\n" << specialStrings << "    };\n\n";
+    out << "    constexpr UnivKbd::StaticSpecials Specials[] = {\n" << specialsEntries << "    };\n\n";
+    out << "    constexpr UnivKbd::StaticKeyboardTable Table = {\n";
+    out << "        Strings, Keyboards, " << keyboards.size() << ", Specials, " << (quint32)specials.size() << ", SpecialStrings\n";
+    out << "    };\n\n";
+    out << "}\n\n";
+    out << "const UnivKbd::StaticKeyboardTable &UnivKbd::Keyboard::staticKeyboards() {\n";
+    out << "    return Table;\n";
+    out << "}\n";
+
+    std::printf("Compiled %d layouts, %d distinct\n", (int)keyboards.size(), (int)keyArrayIndices.size());
+    return 0;
+}